@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench.h
+//    Description:  What the benchmarks share, checks, timing and arguments
+//
+//----------------------------------------------------------------------------
+
+#ifndef   BENCH_H
+#define   BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// A bench prints a line for each thing it checks, with FAILED on the end of
+// any that did not hold, and exits 1 if one failed so make bench stops.
+
+namespace bench {
+  typedef std::chrono::steady_clock hostclock;
+
+  // checks that did not hold
+  inline int32_t  failed = 0;
+
+  //
+  // Prints a check's line, laid out by the format, and counts it if it failed
+  //
+  __attribute__((format(printf, 2, 3)))
+  inline void
+  checkf( bool ok, const char *format, ... ) {
+      va_list args;
+      va_start( args, format );
+      vprintf( format, args );
+      va_end( args );
+      printf( " %s\n", ok ? "" : "FAILED" );
+      if( !ok )
+        failed++;
+  }
+
+  // a check with what was found written out after its name
+  inline void
+  check( const char *name, bool ok, const char *detail ) {
+      checkf( ok, "  %-40s %s", name, detail );
+  }
+
+  // the exit code
+  inline int
+  result( void ) {
+      return( failed ? 1 : 0 );
+  }
+
+  // uniform in low to high from rand, so a seed repeats a run
+  inline double
+  between( double low, double high ) {
+      return( low + (high - low) * rand() / (double)RAND_MAX );
+  }
+
+  // nS from start to now
+  inline double
+  nsSince( hostclock::time_point start ) {
+      return( std::chrono::duration<double, std::nano>( hostclock::now() - start ).count() );
+  }
+
+  // nS a call for calls made since start
+  inline double
+  nsPerCall( hostclock::time_point start, int32_t calls ) {
+      return( nsSince( start ) / calls );
+  }
+
+  //
+  // Times calls calls of f and prints the nS each took under name
+  //
+  template<typename F>
+  double
+  timeCalls( const char *name, int32_t calls, F f ) {
+      auto start = hostclock::now();
+      for( int32_t k = 0; k < calls; k++ )
+        f();
+      double ns = nsPerCall( start, calls );
+      printf( "  %-36s %10.2f   nS a call\n", name, ns );
+      return( ns );
+  }
+
+  //
+  // Prints the p50, p99 and max of samples under name, sorting them
+  //
+  inline void
+  percentiles( const char *name, std::vector<double> &v, const char *units ) {
+      if( v.empty() ) {
+        printf( "  %-20s no samples\n", name );
+        return;
+      }
+      std::sort( v.begin(), v.end() );
+      double p50 = v[ (v.size() - 1) * 50 / 100 ];
+      double p99 = v[ (v.size() - 1) * 99 / 100 ];
+      printf( "  %-20s %10.1f %10.1f %10.1f   %s\n", name, p50, p99, v.back(), units );
+  }
+
+  [[noreturn]] inline void
+  usage( const char *name, const char *args ) {
+      fprintf( stderr, "usage: %s %s\n", name, args );
+      exit( 1 );
+  }
+};
+
+#endif // BENCH_H
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_aggregate.cpp
+//    Description:  motor_group aggregate readings against asking each motor
+//
+//----------------------------------------------------------------------------
+
+// A four motor drive in one motor_group, the right side reversed and one
+// motor geared, with the motors at different speeds and one of them held
+// against a stop so it runs hotter than the rest. Two things
+//
+//   check    - while spinning, once a move has finished and just after
+//              one motor is reversed and moved on its own, the group's
+//              mean velocity in each unit, total current, hottest
+//              temperature in each unit and done are compared with what
+//              asking each motor gives
+//   time     - the same four readings taken the way a program would
+//              without them, a call to each motor for velocity and
+//              temperature plus the group's current and isDone, against
+//              one aggregate call, and each reading on its own both ways
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+#define BENCH_MOTORS          4
+#define BENCH_CALLS           10000000
+
+static motor              _leftFront( PORT1 ), _leftBack( PORT2, 2.0 );
+static motor              _rightFront( PORT5, true ), _rightBack( PORT6, true );
+static motor             *_each[BENCH_MOTORS] = { &_leftFront, &_leftBack, &_rightFront, &_rightBack };
+static motor_group        _drive( _leftFront, _leftBack, _rightFront, _rightBack );
+
+static volatile double    _sink;
+
+/*----------------------------------------------------------------------------*/
+/*  The readings asked of each motor                                          */
+/*----------------------------------------------------------------------------*/
+
+static motor_group::readings
+byHand( velocityUnits units_v, temperatureUnits units_t ) {
+    motor_group::readings r = { 0, 0, -1000, true };
+    for( int32_t i = 0; i < BENCH_MOTORS; i++ ) {
+      r.velocity   += _each[i]->velocity( units_v ) / BENCH_MOTORS;
+      r.temperature = fmax( r.temperature, _each[i]->temperature( units_t ) );
+    }
+    r.current = _drive.current();
+    r.done    = _drive.isDone();
+    return( r );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Checks                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void
+check( const char *name, double got, double want ) {
+    bench::checkf( fabs( got - want ) <= 1e-9 * fmax( 1, fabs( want ) ), "  %-36s %12.6f %12.6f", name, got, want );
+}
+
+static void
+checks( const char *when ) {
+    const velocityUnits    vs[3]     = { velocityUnits::rpm, velocityUnits::dps, velocityUnits::pct };
+    const char            *vnames[3] = { "rpm", "dps", "pct" };
+    char                   name[64];
+
+    printf( "group readings %s, aggregate against each motor\n", when );
+    for( int32_t k = 0; k < 3; k++ ) {
+      motor_group::readings a = _drive.aggregate( vs[k] );
+      motor_group::readings h = byHand( vs[k], temperatureUnits::celsius );
+      snprintf( name, sizeof(name), "mean velocity %s", vnames[k] );
+      check( name, a.velocity, h.velocity );
+      snprintf( name, sizeof(name), "averageVelocity %s", vnames[k] );
+      check( name, _drive.averageVelocity( vs[k] ), h.velocity );
+    }
+
+    motor_group::readings a = _drive.aggregate( velocityUnits::rpm, temperatureUnits::fahrenheit );
+    motor_group::readings h = byHand( velocityUnits::rpm, temperatureUnits::fahrenheit );
+    check( "total current A", a.current, h.current );
+    check( "hottest F", a.temperature, h.temperature );
+    check( "maxTemperature C", _drive.maxTemperature( temperatureUnits::celsius ),
+                               byHand( velocityUnits::rpm, temperatureUnits::celsius ).temperature );
+    check( "done", a.done, h.done );
+
+    // isDone now reads the ports itself, it has to agree with the motors
+    bool all = true;
+    for( int32_t i = 0; i < BENCH_MOTORS; i++ )
+      all = all && _each[i]->isDone();
+    check( "isDone", _drive.isDone(), all );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Timing                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void
+timing() {
+    printf( "group readings, %d motors, %d calls each\n", BENCH_MOTORS, BENCH_CALLS );
+    double hand = bench::timeCalls( "each motor, current and isDone", BENCH_CALLS, [] {
+      motor_group::readings r = byHand( velocityUnits::rpm, temperatureUnits::celsius );
+      _sink = r.velocity + r.current + r.temperature + r.done;
+    } );
+    double one = bench::timeCalls( "aggregate()", BENCH_CALLS, [] {
+      motor_group::readings r = _drive.aggregate();
+      _sink = r.velocity + r.current + r.temperature + r.done;
+    } );
+    printf( "  %-36s %10.1f   x\n", "faster", hand / one );
+
+    bench::timeCalls( "velocity of each motor", BENCH_CALLS, [] {
+      double v = 0;
+      for( int32_t i = 0; i < BENCH_MOTORS; i++ )
+        v += _each[i]->velocity( velocityUnits::rpm );
+      _sink = v / BENCH_MOTORS;
+    } );
+    bench::timeCalls( "averageVelocity( rpm )", BENCH_CALLS, [] { _sink = _drive.averageVelocity( velocityUnits::rpm ); } );
+    bench::timeCalls( "temperature of each motor", BENCH_CALLS, [] {
+      double t = -1000;
+      for( int32_t i = 0; i < BENCH_MOTORS; i++ )
+        t = fmax( t, _each[i]->temperature( temperatureUnits::celsius ) );
+      _sink = t;
+    } );
+    bench::timeCalls( "maxTemperature( celsius )", BENCH_CALLS, [] { _sink = _drive.maxTemperature( temperatureUnits::celsius ); } );
+    bench::timeCalls( "current()", BENCH_CALLS, [] { _sink = _drive.current(); } );
+    bench::timeCalls( "isDone()", BENCH_CALLS, [] { _sink = _drive.isDone(); } );
+
+    // the one pass has to be the cheaper way to get all four
+    if( one >= hand )
+      bench::failed++;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static int
+benchMain() {
+    // different speeds on each side, one motor hot from pushing on its stop
+    _leftFront.spin( forward, 70, percent );
+    _leftBack.spin( forward, 40, percent );
+    _rightFront.spin( forward, 55, percent );
+    _rightBack.spin( forward, 100, percent );
+    task::sleep( 5000 );
+    checks( "while spinning" );
+
+    _drive.spinFor( 90, degrees, 50, velocityUnits::pct, false );
+    task::sleep( 3000 );
+    checks( "after a move" );
+
+    // a motor reversed after it joined the group and given a move of its
+    // own, the group has to see both through its copy of the settings
+    _rightBack.setReversed( false );
+    _rightBack.spin( forward, 60, percent );
+    _leftFront.spinFor( 90, degrees, 50, velocityUnits::pct, false );
+    task::sleep( 50 );
+    checks( "with a motor changed on its own" );
+
+    timing();
+    return( 0 );
+}
+
+int main( int argc, char **argv ) {
+    if( argc > 1 )
+      bench::usage( argv[0], "" );
+
+    sim::motorLoad stop = {};
+    stop.stops = true;
+    stop.low   = -SIM_MOTOR_COUNTS;
+    stop.high  = SIM_MOTOR_COUNTS;
+    sim::setMotorLoad( 5, stop );
+
+    sim::start( benchMain );
+    sim::runFor( 10000 );
+    return( bench::result() );
+}
@@ -0,0 +1,327 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_autograb.cpp
+//    Description:  Sensor to actuator latency of the autoGrab path
+//
+//----------------------------------------------------------------------------
+
+// Runs code.c++ unmodified and pushes the sonar through a series of
+// approach profiles, an object coming towards the claw at a random speed
+// and phase relative to the device poll. For every approach it records
+//
+//   cross    - virtual time the sonar reading first went below 110mm
+//   dispatch - the dist.changed broadcast that follows it
+//   entry    - the autoGrab call that went on to close the claw
+//   claw     - the claw starting to close reaching the motor
+//   stop     - the clamp taking hold once the claw stalls on the object
+//
+// and reports p50/p99/max of each stage measured from the crossing, in
+// virtual time, plus the host time spent between dispatch and the claw
+// command, which is what the runtime itself costs. The object seats in
+// the claw BENCH_SEAT degrees in, the driver opens the claw again with
+// AxisD before the next approach. How fast the claw closed and that it
+// held at the holding torque are checked against code.c++, and the heat
+// the claw put out and its hottest are set against closing for a fixed
+// GRAB_TIME the way autoGrab used to, run on the motor model alone.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+extern "C" int vexUserMain( void );
+
+// ports and threshold as configured in code.c++
+#define BENCH_SONAR_PORT      2       // PORT3
+#define BENCH_CLAW_PORT       7       // PORT8
+#define BENCH_GRAB_MM         110
+#define BENCH_GRAB_SPEED      20      // pct
+#define BENCH_GRAB_HOLD       20      // pct torque
+#define BENCH_GRAB_TIME       2000    // mS, closing time before the clamp
+
+#define BENCH_START_MM        600
+#define BENCH_CLOSEST_MM      60
+#define BENCH_HOLD            100     // mS at closest before the object leaves
+#define BENCH_PERIOD          5000    // mS per approach, autoGrab blocks for 2S
+#define BENCH_STEP            1       // mS between sonar updates
+#define BENCH_SEAT            60      // deg the claw closes before the object stops it
+#define BENCH_OPEN            400     // mS before each approach the driver opens the claw
+#define BENCH_OPEN_TIME       300     // mS the stick is held for
+#define BENCH_AXIS_CLAW       3       // AxisD
+
+using bench::hostclock;
+
+namespace {
+  struct sample {
+    sim::usec_t           cross;
+    sim::usec_t           dispatch;
+    sim::usec_t           entry;
+    sim::usec_t           claw;
+    sim::usec_t           stop;
+    double                speed;
+    bool                  held;       // stopped by holding at BENCH_GRAB_HOLD
+    double                heat;       // J in the windings from closing to opening
+    hostclock::time_point hostDispatch;
+    hostclock::time_point hostClaw;
+  };
+
+  // one approach, distance falls at speed mm/S from start then holds
+  struct profile {
+    sim::usec_t start;
+    double      speed;
+  };
+}
+
+static std::vector<sample>    _samples;
+static std::vector<profile>   _profiles;
+static size_t                 _current  = 0;
+static bool                   _crossed  = false;
+static int32_t                _distance = BENCH_START_MM;
+static bool                   _opening  = false;
+static double                 _hottest  = SIM_MOTOR_AMBIENT;
+
+// the claw command is credited to the most recent autoGrab entry, an
+// earlier entry may have read a stale distance and returned
+static sim::usec_t            _lastEntry = 0;
+
+/*----------------------------------------------------------------------------*/
+/*  Trace hooks                                                               */
+/*----------------------------------------------------------------------------*/
+
+static void
+onEvent( int32_t index, uint32_t mask ) {
+    if( !_crossed || index != BENCH_SONAR_PORT || !(mask & SIM_SONAR_EVENT_CHANGED) )
+      return;
+    sample &s = _samples.back();
+    if( s.dispatch == 0 ) {
+      s.dispatch     = sim::now();
+      s.hostDispatch = hostclock::now();
+    }
+}
+
+static void
+onHandler( int32_t index, uint32_t mask ) {
+    if( index == BENCH_SONAR_PORT )
+      _lastEntry = sim::now();
+}
+
+static void
+onMotor( int32_t index, const sim::motorState &m ) {
+    if( !_crossed || index != BENCH_CLAW_PORT )
+      return;
+    sample &s = _samples.back();
+    bool closing = (m.mode == sim::motorMode::velocity && m.command < 0);
+    if( s.claw == 0 && closing ) {
+      s.entry    = _lastEntry;
+      s.claw     = sim::now();
+      s.hostClaw = hostclock::now();
+    }
+    if( s.claw != 0 && s.stop == 0 ) {
+      if( closing )
+        s.speed = -m.command;
+      else {
+        s.stop = sim::now();
+        s.held = (m.mode == sim::motorMode::hold && m.maxTorque == BENCH_GRAB_HOLD);
+      }
+    }
+}
+
+// the claw's winding heat once a tick, between polls
+static void
+heatStep( void * ) {
+    const sim::motorState &m = sim::frameGet().ports[BENCH_CLAW_PORT].motor;
+    if( _crossed && !_opening && _samples.back().claw != 0 )
+      _samples.back().heat += m.current * m.current * SIM_MOTOR_OHMS * SIM_POLL_INTERVAL / 1000.0;
+    if( m.temperature > _hottest )
+      _hottest = m.temperature;
+    sim::callAt( sim::now() + SIM_POLL_INTERVAL * 1000, heatStep, NULL );
+}
+
+// the driver pushes AxisD up to open the claw, lets go, and does the same
+// ahead of the next approach
+static void
+openStep( void * ) {
+    _opening = !_opening;
+    sim::setAxis( BENCH_AXIS_CLAW, _opening ? 100 : 0 );
+    sim::usec_t next = _opening ? BENCH_OPEN_TIME : BENCH_PERIOD - BENCH_OPEN_TIME;
+    sim::callAt( sim::now() + next * 1000, openStep, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Approach profiles                                                         */
+/*----------------------------------------------------------------------------*/
+
+static void
+profileStep( void * ) {
+    sim::usec_t t = sim::now();
+
+    while( _current + 1 < _profiles.size() && t >= _profiles[_current + 1].start ) {
+      _current++;
+      _crossed = false;
+    }
+
+    const profile &p = _profiles[_current];
+    int32_t d = BENCH_START_MM;
+    if( t >= p.start ) {
+      double      travel = (BENCH_START_MM - BENCH_CLOSEST_MM) / p.speed * 1e6;
+      sim::usec_t dt     = t - p.start;
+      if( dt < travel )
+        d = BENCH_START_MM - (int32_t)(p.speed * dt / 1e6);
+      else
+      if( dt < travel + BENCH_HOLD * 1000 )
+        d = BENCH_CLOSEST_MM;
+    }
+
+    if( d < BENCH_GRAB_MM && !_crossed ) {
+      _crossed = true;
+      _samples.push_back( sample() );
+      _samples.back().cross = t;
+    }
+
+    if( d != _distance ) {
+      _distance = d;
+      sim::setSonar( BENCH_SONAR_PORT, d );
+    }
+    sim::callAt( t + BENCH_STEP * 1000, profileStep, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The grab autoGrab used to make                                            */
+/*----------------------------------------------------------------------------*/
+
+// closing for GRAB_TIME then stopping, on the model alone with the same
+// claw, object and driver, gives the heat per grab and the hottest the
+// claw got over count approaches
+static double
+timedGrab( int32_t count, const sim::motorLoad &load, double *hottest ) {
+    sim::port p;
+    memset( &p, 0, sizeof(p) );
+    p.type              = kDeviceTypeMotorSensor;
+    p.load              = load;
+    p.motor.maxTorque   = 100;
+    p.motor.temperature = SIM_MOTOR_AMBIENT;
+
+    sim::motorState c = p.motor;
+    double heat = 0;
+    *hottest = SIM_MOTOR_AMBIENT;
+    for( int32_t i = 0; i < count; i++ ) {
+      for( int32_t t = 0; t < BENCH_PERIOD; t += SIM_POLL_INTERVAL ) {
+        if( t < BENCH_GRAB_TIME ) {
+          c.mode    = sim::motorMode::velocity;
+          c.command = -BENCH_GRAB_SPEED;
+        }
+        else
+        if( t >= BENCH_PERIOD - BENCH_OPEN && t < BENCH_PERIOD - BENCH_OPEN + BENCH_OPEN_TIME ) {
+          c.mode    = sim::motorMode::velocity;
+          c.command = 100;
+        }
+        else {
+          c.mode    = sim::motorMode::coast;
+          c.command = 0;
+        }
+        sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+        if( t < BENCH_PERIOD - BENCH_OPEN )
+          heat += p.motor.current * p.motor.current * SIM_MOTOR_OHMS * SIM_POLL_INTERVAL / 1000.0;
+        if( p.motor.temperature > *hottest )
+          *hottest = p.motor.temperature;
+      }
+    }
+    return( heat / count );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    int32_t   count = 1000;
+    uint32_t  seed  = 1;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        count = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-n approaches] [--seed n]" );
+    }
+    if( count <= 0 )
+      bench::usage( argv[0], "[-n approaches] [--seed n]" );
+
+    // speeds from a slow nudge to a ball rolling in, start times jittered
+    // so the crossing lands anywhere within the device poll interval
+    srand( seed );
+    for( int32_t i = 0; i < count; i++ ) {
+      profile p;
+      p.start = (sim::usec_t)(i * BENCH_PERIOD + 500) * 1000 + rand() % (SIM_POLL_INTERVAL * 1000);
+      p.speed = 300 + rand() % 1700;
+      _profiles.push_back( p );
+    }
+    _samples.reserve( count );
+
+    sim::trace.eventFire    = onEvent;
+    sim::trace.handlerStart = onHandler;
+    sim::trace.motorCommand = onMotor;
+
+    // console output from the robot program is not wanted here
+    FILE *saved = stdout;
+    stdout = fopen( "/dev/null", "w" );
+
+    // the object seats BENCH_SEAT degrees in, the claw opens as far as it started
+    sim::motorLoad claw = {};
+    claw.stops = true;
+    claw.low   = -BENCH_SEAT / 360.0 * SIM_MOTOR_COUNTS;
+    claw.high  = 0;
+
+    sim::start( vexUserMain );
+    sim::setMotorLoad( BENCH_CLAW_PORT, claw );
+    sim::callAt( 0, profileStep, NULL );
+    sim::callAt( SIM_POLL_INTERVAL * 500, heatStep, NULL );
+    sim::callAt( (BENCH_PERIOD + 500 - BENCH_OPEN) * 1000, openStep, NULL );
+    sim::runFor( count * BENCH_PERIOD + 1000 );
+
+    fclose( stdout );
+    stdout = saved;
+
+    std::vector<double> dispatch, entry, clawed, host, closing, heat;
+    int32_t missed = 0, wrong = 0;
+    for( const sample &s : _samples ) {
+      if( s.claw == 0 ) {
+        missed++;
+        continue;
+      }
+      if( s.stop == 0 || !s.held || s.stop - s.claw >= BENCH_GRAB_TIME * 1000 || s.speed != BENCH_GRAB_SPEED )
+        wrong++;
+      if( s.stop )
+        closing.push_back( (s.stop - s.claw) / 1000.0 );
+      heat.push_back( s.heat );
+      dispatch.push_back( (s.dispatch - s.cross) / 1000.0 );
+      entry.push_back( ((int64_t)s.entry - (int64_t)s.cross) / 1000.0 );
+      clawed.push_back( (s.claw - s.cross) / 1000.0 );
+      host.push_back( std::chrono::duration<double, std::micro>( s.hostClaw - s.hostDispatch ).count() );
+    }
+
+    double hottest;
+    double timed = timedGrab( count, claw, &hottest );
+
+    printf( "autoGrab latency, %d approaches, %d missed, %d grabs not held at %d%% torque after closing at %d%%\n",
+            (int)_samples.size(), missed, wrong, BENCH_GRAB_HOLD, BENCH_GRAB_SPEED );
+    printf( "  %-20s %10s %10s %10s\n", "", "p50", "p99", "max" );
+    bench::percentiles( "sonar -> dispatch", dispatch, "mS" );
+    bench::percentiles( "sonar -> autoGrab", entry, "mS" );
+    bench::percentiles( "sonar -> claw", clawed, "mS" );
+    bench::percentiles( "dispatch -> claw", host, "uS host" );
+    bench::percentiles( "claw closing", closing, "mS" );
+    bench::percentiles( "claw heat", heat, "J a grab" );
+    printf( "  %-20s %10.1f mS closing, %.1f J a grab, hottest %.1fC against %.1fC clamping\n",
+            "timed grab", (double)BENCH_GRAB_TIME, timed, hottest, _hottest );
+    return( (missed || wrong) ? 1 : 0 );
+}
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_group.cpp
+//    Description:  Motor sends per tick with and without group batching
+//
+//----------------------------------------------------------------------------
+
+// An arcade drive, two motors a side in a left and a right motor_group,
+// driven from AxisA and AxisC with both sticks moving every tick. The
+// handler is what a program would write, setVelocity then spin on each
+// group, and it runs once for each axis that changed. The first half of
+// the run sends every command as it is made, the second half has batching
+// on. For every device poll that sends anything it records
+//
+//   sends    - how many transactions went out on the bus
+//   skew     - the spread of when each drive motor's last command landed
+//   settled  - when the last of them landed, from the start of the poll
+//
+// and reports p50/p99/max of each for the two halves, in virtual time
+// with the nominal SIM_MOTOR_SEND_US per transaction.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+#define BENCH_AXIS_FWD        0       // AxisA
+#define BENCH_AXIS_TURN       2       // AxisC
+
+static const int32_t _ports[] = { 0, 1, 4, 5 };   // PORT1, PORT2 left, PORT5, PORT6 right
+#define BENCH_MOTORS          (int32_t)(sizeof(_ports) / sizeof(_ports[0]))
+
+static motor        _leftFront( PORT1 ), _leftBack( PORT2 );
+static motor        _rightFront( PORT5, true ), _rightBack( PORT6, true );
+static motor_group  _left( _leftFront, _leftBack );
+static motor_group  _right( _rightFront, _rightBack );
+static controller   _controller;
+
+namespace {
+  struct poll {
+    sim::usec_t   time;
+    int32_t       sends;
+    sim::usec_t   last;
+    sim::usec_t   landed[BENCH_MOTORS];
+  };
+
+  struct results {
+    std::vector<double> sends, skew, settled;
+  };
+}
+
+static std::vector<poll>  _polls[2];
+static int32_t            _phase;
+static int32_t            _duration;
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static void
+drive() {
+    int32_t fwd  = _controller.AxisA.position( percent );
+    int32_t turn = _controller.AxisC.position( percent );
+
+    _left.setVelocity( fwd + turn, percent );
+    _right.setVelocity( fwd - turn, percent );
+    _left.spin( forward );
+    _right.spin( forward );
+}
+
+static int
+benchMain() {
+    _controller.AxisA.changed( drive );
+    _controller.AxisC.changed( drive );
+
+    task::sleep( _duration );
+    _phase = 1;
+    _left.setBatching( true );
+    _right.setBatching( true );
+    task::sleep( _duration );
+    return( 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Sticks and trace hook                                                     */
+/*----------------------------------------------------------------------------*/
+
+// new stick positions half way between polls
+static void
+sticks( void * ) {
+    sim::setAxis( BENCH_AXIS_FWD, rand() % 201 - 100 );
+    sim::setAxis( BENCH_AXIS_TURN, rand() % 201 - 100 );
+    sim::callAt( sim::now() + SIM_POLL_INTERVAL * 1000, sticks, NULL );
+}
+
+static void
+onSent( int32_t index, sim::usec_t time ) {
+    std::vector<poll> &v = _polls[_phase];
+    if( v.empty() || v.back().time != sim::now() ) {
+      v.push_back( poll() );
+      v.back().time = sim::now();
+    }
+    poll &p = v.back();
+    if( time != p.last )
+      p.sends++;
+    p.last = time;
+    for( int32_t i = 0; i < BENCH_MOTORS; i++ )
+      if( _ports[i] == index )
+        p.landed[i] = time - p.time;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+// polls that sent to every drive motor, leaving out the first which may
+// have been queued before batching changed
+static results
+measure( const std::vector<poll> &polls ) {
+    results r;
+    for( size_t k = 1; k < polls.size(); k++ ) {
+      const poll &p = polls[k];
+      sim::usec_t first = *std::min_element( p.landed, p.landed + BENCH_MOTORS );
+      sim::usec_t last  = *std::max_element( p.landed, p.landed + BENCH_MOTORS );
+      if( first == 0 )
+        continue;
+      r.sends.push_back( p.sends );
+      r.skew.push_back( (double)(last - first) );
+      r.settled.push_back( (double)last );
+    }
+    return( r );
+}
+
+int main( int argc, char **argv ) {
+    int32_t   seconds = 60;
+    uint32_t  seed    = 1;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        seconds = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-t seconds] [--seed n]" );
+    }
+    if( seconds <= 0 )
+      bench::usage( argv[0], "[-t seconds] [--seed n]" );
+
+    srand( seed );
+    _duration = seconds * 1000;
+    sim::trace.motorSent = onSent;
+
+    sim::start( benchMain );
+    sim::callAt( SIM_POLL_INTERVAL * 500, sticks, NULL );
+    sim::runFor( 2 * _duration + 100 );
+
+    results r[2] = { measure( _polls[0] ), measure( _polls[1] ) };
+    int32_t worst = r[1].sends.empty() ? 0 : (int32_t)*std::max_element( r[1].sends.begin(), r[1].sends.end() );
+
+    printf( "motor_group sends, %d drive motors, %d polls each way, %duS per send\n",
+            BENCH_MOTORS, (int)std::min( r[0].sends.size(), r[1].sends.size() ), SIM_MOTOR_SEND_US );
+    for( int32_t b = 0; b < 2; b++ ) {
+      printf( "  %-20s %10s %10s %10s\n", b ? "batched" : "each command", "p50", "p99", "max" );
+      bench::percentiles( "sends", r[b].sends, "per poll" );
+      bench::percentiles( "skew", r[b].skew, "uS" );
+      bench::percentiles( "settled", r[b].settled, "uS" );
+    }
+
+    // batched, the drive is one send per poll and every motor lands together
+    int32_t skewed = r[1].skew.empty() ? 0 : (int32_t)*std::max_element( r[1].skew.begin(), r[1].skew.end() );
+    return( (r[1].sends.empty() || worst > 1 || skewed > 0) ? 1 : 0 );
+}
@@ -0,0 +1,230 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_joystick.cpp
+//    Description:  Motor commands from a jittery stick, handler against binding
+//
+//----------------------------------------------------------------------------
+
+// A driver on AxisD holds the stick at a random position for a while, then
+// moves it to another over a fifth of a second, and the whole time it
+// jitters by up to BENCH_JITTER percent either way as a real stick does. The
+// same stick drives two motors at once
+//
+//   handler  - a motor on PORT10 driven by a changed handler that spins it
+//              and sets its velocity, as clawMovement did
+//   clawTask - the claw, driven by code.c++ run unmodified, which shapes,
+//              slews and thresholds the stick every CLAW_TICK
+//
+// and for each it counts the changed events the axis raised, the commands
+// the motor was given and the sends that went out on the bus. At the end
+// of every hold the last command each motor got is checked against where
+// the stick was held, shaped for the claw as code.c++ does, to within the
+// threshold and the jitter.
+//
+// All the while AxisC has a coalescing rule that would fold every trigger
+// on the controller into one a second if it were not kept to AxisC, and
+// ButtonFUp is pressed every BENCH_PRESS. Its handler has to run for every
+// press.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+extern "C" int vexUserMain( void );
+
+// ports and stick settings as configured in code.c++
+#define BENCH_AXIS            3       // AxisD
+#define BENCH_CLAW_PORT       7       // PORT8
+#define BENCH_DEADBAND        5
+#define BENCH_CURVE           0.5
+#define BENCH_THRESHOLD       3
+
+#define BENCH_HANDLER_PORT    9       // PORT10
+#define BENCH_JITTER          1       // pct either way
+#define BENCH_MOVE            200     // mS to move the stick
+
+#define BENCH_RULE_AXIS       2       // AxisC
+#define BENCH_BUTTON          2       // ButtonFUp
+#define BENCH_PRESS           250     // mS between presses, held for half
+
+static motor          _handled( PORT10 );
+static controller     _controller;
+
+static const char    *_names[2] = { "handler", "clawTask" };
+static const int32_t  _ports[2] = { BENCH_HANDLER_PORT, BENCH_CLAW_PORT };
+
+static uint32_t       _events;
+static uint32_t       _commands[2];
+static uint32_t       _sends[2];
+static double         _sent[2];       // pct, the last velocity commanded
+static double         _worst[2];      // pct off where the stick was held
+static int32_t        _holds;
+
+// the stick
+static double         _from, _to;     // pct
+static sim::usec_t    _moved, _until; // moving until _moved, held until _until
+
+// the button
+static uint32_t       _presses;
+static uint32_t       _pressed;       // times its handler ran
+static sim::usec_t    _lastPress;     // mS, presses stop here
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static void
+clawMovement() {
+    _handled.spin( forward );
+    _handled.setVelocity( _controller.AxisD.position( percent ), percent );
+}
+
+static void
+buttonPressed() {
+    _pressed++;
+}
+
+// code.c++ with the old way beside it
+static int
+benchMain() {
+    _controller.AxisD.changed( clawMovement );
+    _controller.ButtonFUp.pressed( buttonPressed );
+    return( vexUserMain() );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Stick and trace hooks                                                     */
+/*----------------------------------------------------------------------------*/
+
+// what clawTask makes of a pct, as code.c++ does
+static double
+shaped( double pct ) {
+    double mag = fabs( pct );
+    if( mag <= BENCH_DEADBAND )
+      return( 0 );
+    double x = (mag - BENCH_DEADBAND) / (100.0 - BENCH_DEADBAND);
+    double y = (1 - BENCH_CURVE) * x + BENCH_CURVE * x * x * x;
+    return( pct < 0 ? -100 * y : 100 * y );
+}
+
+// new stick positions half way between polls
+static void
+stick( void * ) {
+    sim::usec_t t = sim::now();
+
+    if( t >= _until ) {
+      // the last commands should be where the stick was held
+      if( _until != 0 ) {
+        _worst[0] = fmax( _worst[0], fabs( _sent[0] - _to ) );
+        _worst[1] = fmax( _worst[1], fabs( _sent[1] - shaped( _to ) ) );
+        _holds++;
+      }
+
+      _from  = _to;
+      _to    = rand() % 201 - 100;
+      _moved = t + BENCH_MOVE * 1000;
+      _until = _moved + (300 + rand() % 1700) * 1000;
+    }
+
+    double pct = _to;
+    if( t < _moved )
+      pct = _to - (_to - _from) * (_moved - t) / (BENCH_MOVE * 1000.0);
+    pct += rand() % (2 * BENCH_JITTER + 1) - BENCH_JITTER;
+    sim::setAxis( BENCH_AXIS, (int32_t)fmax( -100, fmin( 100, pct ) ) );
+    sim::callAt( t + SIM_POLL_INTERVAL * 1000, stick, NULL );
+}
+
+// a press and release every BENCH_PRESS
+static void
+press( void *down ) {
+    sim::usec_t t = sim::now();
+    if( t / 1000 > _lastPress )
+      return;
+    sim::setButton( BENCH_BUTTON, down != NULL );
+    if( down )
+      _presses++;
+    sim::callAt( t + BENCH_PRESS * 500, press, down ? NULL : (void *)1 );
+}
+
+static void
+onEvent( int32_t index, uint32_t mask ) {
+    if( index == SIM_INDEX_CONTROLLER && (mask & (1 << (16 + BENCH_AXIS))) )
+      _events++;
+}
+
+static void
+onMotor( int32_t index, const sim::motorState &m ) {
+    for( int32_t k = 0; k < 2; k++ ) {
+      if( index == _ports[k] ) {
+        _commands[k]++;
+        _sent[k] = m.command;
+      }
+    }
+}
+
+static void
+onSent( int32_t index, sim::usec_t time ) {
+    for( int32_t k = 0; k < 2; k++ ) {
+      if( index == _ports[k] )
+        _sends[k]++;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    int32_t   seconds = 300;
+    uint32_t  seed    = 1;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        seconds = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-t seconds] [--seed n]" );
+    }
+    if( seconds <= 0 )
+      bench::usage( argv[0], "[-t seconds] [--seed n]" );
+
+    srand( seed );
+    sim::trace.eventFire    = onEvent;
+    sim::trace.motorCommand = onMotor;
+    sim::trace.motorSent    = onSent;
+
+    // a second apart, on AxisC only
+    sim::coalescePolicy rule = { sim::coalesceType::interval, 1000 };
+    sim::eventCoalesce( SIM_INDEX_CONTROLLER, 1 << (16 + BENCH_RULE_AXIS), NULL, rule );
+    _lastPress = (seconds - 1) * 1000;
+
+    sim::start( benchMain );
+    sim::callAt( SIM_POLL_INTERVAL * 500, stick, NULL );
+    sim::callAt( SIM_POLL_INTERVAL * 500, press, (void *)1 );
+    sim::runFor( seconds * 1000 );
+
+    printf( "AxisD driving a motor, %dS, stick jitter %d%%, threshold %d%%\n", seconds, BENCH_JITTER, BENCH_THRESHOLD );
+    printf( "  %-10s %10s %10s %10s %10s %12s\n", "", "events", "commands", "sends", "per event", "worst hold" );
+    for( int32_t k = 0; k < 2; k++ ) {
+      // the claw is off by no more than the threshold and the jitter
+      bench::checkf( k == 0 || _worst[k] <= BENCH_THRESHOLD + BENCH_JITTER + 1, "  %-10s %10u %10u %10u %10.2f %10.1f %%",
+                     _names[k], _events, _commands[k], _sends[k], _events ? (double)_commands[k] / _events : 0.0, _worst[k] );
+    }
+
+    // clawTask has to send less than the handler did for the same stick
+    bench::checkf( _commands[1] < _commands[0] && _holds > 0, "  %-10s %10d", "holds", _holds );
+
+    // the rule on AxisC leaves the button alone
+    char detail[64];
+    snprintf( detail, sizeof(detail), "%u of %u presses", _pressed, _presses );
+    bench::check( "ButtonFUp beside an AxisC rule", _presses > 0 && _pressed == _presses, detail );
+    return( bench::result() );
+}
@@ -0,0 +1,491 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_lcd.cpp
+//    Description:  Checks and times the brain::lcd rasterizer
+//
+//----------------------------------------------------------------------------
+
+// Four things, in order
+//
+//   check  - random draw calls go to Brain.Screen and to a plain one pixel
+//            at a time model of the same primitives, the two panels must
+//            match after every call
+//   format - the formatting print uses is checked against snprintf on
+//            random values and the two are timed
+//   time   - each scene is drawn many times, reporting nS per draw call for
+//            the rasterizer and for the pixel model
+//   golden - the last frame of every scene is compared with PBM files from
+//            an earlier --save, so a change that moves pixels shows up
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+static brain::lcd     _screen;
+
+/*----------------------------------------------------------------------------*/
+/*  Pixel at a time model                                                     */
+/*----------------------------------------------------------------------------*/
+
+namespace {
+  struct model {
+    uint8_t   px[SIM_LCD_HEIGHT][SIM_LCD_WIDTH];
+    int       pen;
+    bool      fg, bg, transparent, aspect;
+    int       ox, oy;
+
+    void clear() {
+      memset( px, 0, sizeof(px) );
+    }
+    int sy( int y ) {
+      return( aspect ? (y * 3) / 4 : y );
+    }
+    void plot( int x, int y, bool on ) {
+      if( x >= 0 && x < SIM_LCD_WIDTH && y >= 0 && y < SIM_LCD_HEIGHT )
+        px[y][x] = on;
+    }
+    void flip( int x, int y ) {
+      if( x >= 0 && x < SIM_LCD_WIDTH && y >= 0 && y < SIM_LCD_HEIGHT )
+        px[y][x] ^= 1;
+    }
+    void fill( int x, int y, int w, int h, bool on ) {
+      for( int j = y; j < y + h; j++ )
+        for( int i = x; i < x + w; i++ )
+          plot( i, j, on );
+    }
+    void pixel( int x, int y ) {
+      fill( ox + x, oy + sy( y ), pen, pen, fg );
+    }
+    void line( int x1, int y1, int x2, int y2 ) {
+      int dx =  abs( x2 - x1 ), sx = x1 < x2 ? 1 : -1;
+      int dy = -abs( y2 - y1 ), sy = y1 < y2 ? 1 : -1;
+      int err = dx + dy;
+      for(;;) {
+        pixel( x1, y1 );
+        if( x1 == x2 && y1 == y2 )
+          break;
+        int e2 = 2 * err;
+        if( e2 >= dy ) { err += dy; x1 += sx; }
+        if( e2 <= dx ) { err += dx; y1 += sy; }
+      }
+    }
+    void rect( int x, int y, int w, int h ) {
+      int px0 = ox + x, py0 = oy + sy( y ), hh = sy( h );
+      if( !transparent )
+        fill( px0, py0, w, hh, bg );
+      fill( px0,           py0,            w,   pen, fg );
+      fill( px0,           py0 + hh - pen, w,   pen, fg );
+      fill( px0,           py0,            pen, hh,  fg );
+      fill( px0 + w - pen, py0,            pen, hh,  fg );
+    }
+    void invertRect( int x, int y, int w, int h ) {
+      int px0 = ox + x, py0 = oy + sy( y ), hh = sy( h );
+      for( int j = py0; j < py0 + hh; j++ )
+        for( int i = px0; i < px0 + w; i++ )
+          flip( i, j );
+    }
+    void circle( int x, int y, int r ) {
+      int cx = ox + x, cy = oy + sy( y );
+      int r2 = r * r, ri = r - pen, i2 = ri > 0 ? ri * ri : 0;
+      for( int j = -r; j <= r; j++ )
+        for( int i = -r; i <= r; i++ ) {
+          int d = i * i + j * j;
+          if( d > r2 )
+            continue;
+          if( ri <= 0 || d > i2 )
+            plot( cx + i, cy + sy( j ), fg );
+          else
+          if( !transparent )
+            plot( cx + i, cy + sy( j ), bg );
+        }
+    }
+    void invertCircle( int x, int y, int r ) {
+      int cx = ox + x, cy = oy + sy( y );
+      for( int j = -r; j <= r; j++ )
+        for( int i = -r; i <= r; i++ )
+          if( i * i + j * j <= r * r )
+            flip( cx + i, cy + j );
+    }
+  };
+}
+
+static model  _model;
+
+/*----------------------------------------------------------------------------*/
+/*  Draw calls, each goes to the screen, the model or both                    */
+/*----------------------------------------------------------------------------*/
+
+enum drawOp { OP_PIXEL, OP_LINE, OP_RECT, OP_INVERT_RECT, OP_CIRCLE, OP_INVERT_CIRCLE, OP_COUNT };
+
+namespace {
+  struct drawCall {
+    drawOp    op;
+    int       a, b, c, d;
+    int       pen;
+    bool      fg, bg, transparent, aspect;
+    int       ox, oy;
+  };
+}
+
+static void
+screenDraw( const drawCall &k ) {
+    _screen.setPenWidth( k.pen );
+    _screen.setPenColor( k.fg ? colorType::black : colorType::white );
+    _screen.setFillColor( k.transparent ? colorType::transparent : (k.bg ? colorType::black : colorType::white) );
+    _screen.setAspectCompensation( k.aspect );
+    _screen.setOrigin( k.ox, k.oy );
+
+    switch( k.op ) {
+      case OP_PIXEL:          _screen.drawPixel( k.a, k.b );              break;
+      case OP_LINE:           _screen.drawLine( k.a, k.b, k.c, k.d );     break;
+      case OP_RECT:           _screen.drawRectangle( k.a, k.b, k.c, k.d ); break;
+      case OP_INVERT_RECT:    _screen.invertRectangle( k.a, k.b, k.c, k.d ); break;
+      case OP_CIRCLE:         _screen.drawCircle( k.a, k.b, k.c );        break;
+      case OP_INVERT_CIRCLE:  _screen.invertCircle( k.a, k.b, k.c );      break;
+      default:                                                            break;
+    }
+}
+
+static void
+modelDraw( const drawCall &k ) {
+    model &m = _model;
+    m.pen = k.pen; m.fg = k.fg; m.bg = k.bg; m.transparent = k.transparent;
+    m.aspect = k.aspect; m.ox = k.ox; m.oy = k.oy;
+
+    switch( k.op ) {
+      case OP_PIXEL:          m.pixel( k.a, k.b );                  break;
+      case OP_LINE:           m.line( k.a, k.b, k.c, k.d );         break;
+      case OP_RECT:           m.rect( k.a, k.b, k.c, k.d );         break;
+      case OP_INVERT_RECT:    m.invertRect( k.a, k.b, k.c, k.d );   break;
+      case OP_CIRCLE:         m.circle( k.a, k.b, k.c );            break;
+      case OP_INVERT_CIRCLE:  m.invertCircle( k.a, k.b, k.c );      break;
+      default:                                                      break;
+    }
+}
+
+// anything from fully on screen to mostly clipped
+static drawCall
+randomCall( drawOp op ) {
+    drawCall k;
+    k.op          = op;
+    k.a           = rand() % 160 - 16;
+    k.b           = rand() % 96 - 16;
+    k.c           = (op == OP_LINE) ? rand() % 160 - 16 : 1 + rand() % 60;
+    k.d           = (op == OP_LINE) ? rand() % 96 - 16 : 1 + rand() % 40;
+    k.pen         = 1 + rand() % 3;
+    k.fg          = rand() % 4 != 0;
+    k.bg          = rand() % 2;
+    k.transparent = rand() % 3 == 0;
+    k.aspect      = rand() % 4 == 0;
+    k.ox          = rand() % 3 == 0 ? rand() % 20 - 10 : 0;
+    k.oy          = rand() % 3 == 0 ? rand() % 20 - 10 : 0;
+    if( op == OP_CIRCLE || op == OP_INVERT_CIRCLE )
+      k.c = 1 + rand() % 30;
+    return( k );
+}
+
+static int32_t
+differences() {
+    int32_t n = 0;
+    for( int y = 0; y < SIM_LCD_HEIGHT; y++ )
+      for( int x = 0; x < SIM_LCD_WIDTH; x++ )
+        if( sim::lcdPixel( x, y ) != (_model.px[y][x] != 0) )
+          n++;
+    return( n );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Scenes                                                                    */
+/*----------------------------------------------------------------------------*/
+
+namespace {
+  struct scene {
+    const char *name;
+    drawOp      op;           // OP_COUNT for the text screen
+    int32_t     calls;        // draw calls per frame
+  };
+}
+
+static const scene _scenes[] = {
+    { "text",          OP_COUNT,          7 },
+    { "pixels",        OP_PIXEL,         64 },
+    { "lines",         OP_LINE,          16 },
+    { "rectangles",    OP_RECT,          16 },
+    { "invert-rect",   OP_INVERT_RECT,   16 },
+    { "circles",       OP_CIRCLE,        16 },
+    { "invert-circle", OP_INVERT_CIRCLE, 16 },
+};
+
+// the screens code.c++ draws
+static void
+textFrame() {
+    _screen.clearScreen();
+    _screen.setCursor( 1, 1 );
+    _screen.print( "Baller: v1.0" );
+    _screen.setCursor( 2, 1 );
+    _screen.print( "Battery: %d%%", 87 );
+    _screen.setCursor( 3, 1 );
+    _screen.print( "Object found: %d", 1 );
+    _screen.setCursor( 4, 1 );
+    _screen.print( "Distance: %dmm", 104 );
+    _screen.clearLine( 5 );
+}
+
+static bool
+golden( const char *dir, const char *name, bool save ) {
+    char path[256];
+    snprintf( path, sizeof(path), "%s/%s.pbm", dir, name );
+
+    if( save ) {
+      FILE *fp = fopen( path, "wb" );
+      if( fp == NULL ) {
+        fprintf( stderr, "cannot write %s\n", path );
+        return( false );
+      }
+      sim::lcdSavePbm( fp );
+      fclose( fp );
+      return( true );
+    }
+
+    // write this frame the same way and compare bytes
+    char   *now = NULL, *old = NULL;
+    size_t  nowLen = 0, oldLen = 0;
+    FILE   *mem = open_memstream( &now, &nowLen );
+    sim::lcdSavePbm( mem );
+    fclose( mem );
+
+    FILE *fp = fopen( path, "rb" );
+    if( fp == NULL ) {
+      fprintf( stderr, "no golden frame %s\n", path );
+      free( now );
+      return( false );
+    }
+    old = (char *)malloc( nowLen + 1 );
+    oldLen = fread( old, 1, nowLen + 1, fp );
+    fclose( fp );
+
+    bool same = (oldLen == nowLen && memcmp( old, now, nowLen ) == 0);
+    if( !same )
+      fprintf( stderr, "%s differs from %s\n", name, path );
+    free( old );
+    free( now );
+    return( same );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Formatting                                                                */
+/*----------------------------------------------------------------------------*/
+
+// each case formats one random value with format::render, which print
+// uses, and with snprintf, into a row sized buffer
+namespace {
+  struct formatCase {
+    const char   *format;
+    format::kind  type;
+  };
+}
+
+static const formatCase _formats[] = {
+    { "Distance: %dmm",   format::kind::sint },
+    { "%5d",              format::kind::sint },
+    { "%-5d|",            format::kind::sint },
+    { "%05d",             format::kind::sint },
+    { "%u",               format::kind::uint },
+    { "%x",               format::kind::uint },
+    { "%08X",             format::kind::uint },
+    { "[%c]",             format::kind::sint },
+    { "%-8s|",            format::kind::text },
+    { "%40s",             format::kind::text },
+    { "%.3s|",            format::kind::text },
+    { "%-6.2s|",          format::kind::text },
+    { "%.0s|",            format::kind::text },
+    { "%.2f",             format::kind::real },
+    { "%8.3f",            format::kind::real },
+    { "%f",               format::kind::real },
+    { "%06.1f",           format::kind::real },
+    { "Claw Pos: %.0f",   format::kind::real },
+};
+
+#define FORMAT_COUNT  (int32_t)(sizeof(_formats) / sizeof(_formats[0]))
+
+static const char *_words[] = { "", "a", "claw", "Baller: v1.0", "found" };
+
+static format::arg
+randomArg( const formatCase &c ) {
+    switch( c.type ) {
+      case format::kind::sint:
+        if( strchr( c.format, 'c' ) )
+          return( format::arg( (char)(0x20 + rand() % 0x5F) ) );
+        return( format::arg( (int32_t)(rand() % 2 ? rand() % 2000 - 1000 : rand() - RAND_MAX / 2) ) );
+      case format::kind::uint:
+        return( format::arg( (uint32_t)rand() * 2 ) );
+      case format::kind::real:
+        // not a multiple of a power of two, so never exactly half way
+        return( format::arg( (rand() - RAND_MAX / 2) / 997.0 / (1 << (rand() % 16)) ) );
+      default:
+        return( format::arg( _words[rand() % 5] ) );
+    }
+}
+
+static void
+withSnprintf( char *buf, size_t len, const formatCase &c, const format::arg &a ) {
+    switch( c.type ) {
+      case format::kind::sint: snprintf( buf, len, c.format, (int)a.i );      break;
+      case format::kind::uint: snprintf( buf, len, c.format, (unsigned)a.u ); break;
+      case format::kind::real: snprintf( buf, len, c.format, a.f );           break;
+      default:                 snprintf( buf, len, c.format, a.s );           break;
+    }
+}
+
+static void
+formatBench( int32_t frames, uint32_t seed, int32_t &bad ) {
+    std::vector<format::arg> args;
+    std::vector<int32_t>     cases;
+    char                     a[32], b[32];
+
+    srand( seed );
+    for( int32_t i = 0; i < frames * 16; i++ ) {
+      cases.push_back( rand() % FORMAT_COUNT );
+      args.push_back( randomArg( _formats[cases.back()] ) );
+    }
+
+    bad = 0;
+    for( size_t i = 0; i < cases.size(); i++ ) {
+      const formatCase &c = _formats[cases[i]];
+      format::render( a, sizeof(a), c.format, &args[i], 1 );
+      withSnprintf( b, sizeof(b), c, args[i] );
+      if( strcmp( a, b ) != 0 && bad++ == 0 )
+        fprintf( stderr, "format \"%s\" gave \"%s\", snprintf \"%s\"\n", c.format, a, b );
+    }
+    printf( "format check, %d calls, %d differ from snprintf\n", (int)cases.size(), bad );
+
+    auto start = hostclock::now();
+    for( size_t i = 0; i < cases.size(); i++ )
+      format::render( a, sizeof(a), _formats[cases[i]].format, &args[i], 1 );
+    double fast = bench::nsPerCall( start, cases.size() );
+    start = hostclock::now();
+    for( size_t i = 0; i < cases.size(); i++ )
+      withSnprintf( b, sizeof(b), _formats[cases[i]], args[i] );
+    double slow = bench::nsPerCall( start, cases.size() );
+    printf( "  %-16s %12s %12s %8s\n", "", "nS/call", "snprintf nS", "speedup" );
+    printf( "  %-16s %12.1f %12.1f %7.1fx\n", "format", fast, slow, slow / fast );
+}
+
+int main( int argc, char **argv ) {
+    int32_t     frames = 2000;
+    uint32_t    seed   = 1;
+    const char *dir    = NULL;
+    bool        save   = false;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        frames = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+      if( (strcmp( argv[i], "--save" ) == 0 || strcmp( argv[i], "--check" ) == 0) && i + 1 < argc ) {
+        save = (strcmp( argv[i], "--save" ) == 0);
+        dir  = argv[++i];
+      }
+      else
+        bench::usage( argv[0], "[-n frames] [--seed n] [--save dir | --check dir]" );
+    }
+    if( frames <= 0 )
+      bench::usage( argv[0], "[-n frames] [--seed n] [--save dir | --check dir]" );
+
+    // check, every call against the model
+    int32_t bad = 0, calls = 0;
+    srand( seed );
+    _screen.clearScreen();
+    _model.clear();
+    for( int32_t i = 0; i < frames * 4; i++ ) {
+      drawCall k = randomCall( (drawOp)(rand() % OP_COUNT) );
+      screenDraw( k );
+      modelDraw( k );
+      calls++;
+      int32_t n = differences();
+      if( n ) {
+        if( bad++ == 0 )
+          fprintf( stderr, "call %d op %d (%d,%d,%d,%d) pen %d: %d pixels differ\n",
+                   i, k.op, k.a, k.b, k.c, k.d, k.pen, n );
+        // start again from the same picture
+        _screen.clearScreen();
+        _model.clear();
+      }
+    }
+    printf( "lcd check, %d calls, %d differ from the pixel model\n", calls, bad );
+
+    int32_t badFormats;
+    formatBench( frames, seed, badFormats );
+
+    // time, and keep the last frame of each scene for the golden check
+    int32_t mismatched = 0;
+    printf( "  %-16s %12s %12s %8s\n", "scene", "nS/call", "model nS", "speedup" );
+    for( const scene &sc : _scenes ) {
+      double fast, slow = 0;
+
+      // the calls are made up front so only drawing is timed
+      std::vector<drawCall> list;
+      srand( seed );
+      for( int32_t i = 0; sc.op != OP_COUNT && i < frames * sc.calls; i++ )
+        list.push_back( randomCall( sc.op ) );
+
+      auto start = hostclock::now();
+      for( int32_t f = 0; f < frames; f++ ) {
+        if( sc.op == OP_COUNT )
+          textFrame();
+        else {
+          _screen.clearScreen();
+          for( int32_t c = 0; c < sc.calls; c++ )
+            screenDraw( list[f * sc.calls + c] );
+        }
+      }
+      fast = bench::nsPerCall( start, frames * sc.calls );
+
+      if( sc.op != OP_COUNT ) {
+        start = hostclock::now();
+        for( int32_t f = 0; f < frames; f++ ) {
+          _model.clear();
+          for( int32_t c = 0; c < sc.calls; c++ )
+            modelDraw( list[f * sc.calls + c] );
+        }
+        slow = bench::nsPerCall( start, frames * sc.calls );
+      }
+
+      if( slow > 0 )
+        printf( "  %-16s %12.1f %12.1f %7.1fx\n", sc.name, fast, slow, slow / fast );
+      else
+        printf( "  %-16s %12.1f %12s %8s\n", sc.name, fast, "-", "-" );
+
+      if( dir && !golden( dir, sc.name, save ) )
+        mismatched++;
+    }
+    // pushing a frame that changed everywhere, then one that did not change
+    auto start = hostclock::now();
+    for( int32_t f = 0; f < frames; f++ ) {
+      _screen.invertRectangle( 0, 0, SIM_LCD_WIDTH, SIM_LCD_HEIGHT );
+      sim::lcdPush();
+    }
+    printf( "  %-16s %12.1f\n", "push full", bench::nsPerCall( start, frames ) );
+    start = hostclock::now();
+    for( int32_t f = 0; f < frames; f++ ) {
+      textFrame();
+      sim::lcdPush();
+    }
+    printf( "  %-16s %12.1f\n", "text + push", bench::nsPerCall( start, frames ) );
+
+    if( dir )
+      printf( "golden frames %s %s, %d differ\n", save ? "saved to" : "checked against", dir, mismatched );
+
+    return( (bad || badFormats || mismatched) ? 1 : 0 );
+}
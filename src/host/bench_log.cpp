@@ -0,0 +1,272 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_log.cpp
+//    Description:  Checks and times the deferred logger
+//
+//----------------------------------------------------------------------------
+
+// Three things, in order
+//
+//   check  - random messages are logged to a log file in memory, read back
+//            the way logdecode does and compared with snprintf
+//   full   - the ring is filled without draining, what does not fit must be
+//            dropped and counted and what did fit must come out intact
+//   time   - what logging costs the caller, for each kind of message and
+//            for the mix, against formatting the same messages with snprintf
+//            and with vfprintf to /dev/null, which is what
+//            Brain.Terminal.print used to do
+//
+// Nothing is formatted at the call, a write is the compare and swap that
+// reserves the record, the raw argument words and string copies, and the
+// store that publishes it. The first and last cost about 16 nS together on
+// an x86 host, so a write with no arguments is near 20 nS and the rest is
+// the arguments.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <string>
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+static const char *_words[] = { "", "claw", "Baller: v1.0", "a string well past the sixty four characters a log record keeps" };
+
+/*----------------------------------------------------------------------------*/
+/*  Reading a log file back                                                   */
+/*----------------------------------------------------------------------------*/
+
+// the formatted messages in a log file, and the dropped count at its end
+static std::vector<std::string>
+readBack( const char *buf, size_t len, uint32_t &dropped ) {
+    std::vector<std::string> out;
+    std::vector<std::pair<uint64_t, std::string>> formats;
+    const uint64_t *w   = (const uint64_t *)(buf + strlen( SIM_LOG_MAGIC ));
+    const uint64_t *end = (const uint64_t *)(buf + len);
+    char            text[256];
+
+    dropped = 0;
+    while( w < end ) {
+      if( w[0] == 0 ) {
+        if( w[1] == 0 ) {
+          dropped = w[2];
+          break;
+        }
+        formats.push_back( { w[1], std::string( (const char *)(w + 3), w[2] ) } );
+        w += 3 + (w[2] + 8) / 8;
+        continue;
+      }
+      const char *format = "";
+      for( auto &f : formats )
+        if( f.first == w[1] )
+          format = f.second.c_str();
+      sim::logRender( w, format, text, sizeof(text) );
+      out.push_back( text );
+      w += SIM_LOG_LENGTH( w[0] );
+    }
+    return( out );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Messages                                                                  */
+/*----------------------------------------------------------------------------*/
+
+namespace {
+  struct message {
+    int32_t     type;
+    int32_t     i;
+    double      f;
+    const char *s;
+  };
+}
+
+#define MESSAGE_TYPES   4     // randomMessage picks from these
+#define MESSAGE_KINDS   5     // and the one with no arguments
+
+static const char *_kinds[MESSAGE_KINDS] = { "two ints", "a float", "string, int, hex", "a string", "no arguments" };
+
+static message
+randomMessage() {
+    message m;
+    m.type = rand() % MESSAGE_TYPES;
+    m.i    = rand() % 2 ? rand() % 2000 - 1000 : rand();
+    m.f    = (rand() - RAND_MAX / 2) / 997.0;
+    m.s    = _words[rand() % 4];
+    return( m );
+}
+
+static bool
+logMessage( const message &m ) {
+    switch( m.type ) {
+      case 0:  return( logger::write( logger::sink::terminal, "grab %d at %dmm\n", m.i, m.i / 7 ) );
+      case 1:  return( logger::write( logger::sink::terminal, "claw %.2f deg\n", m.f ) );
+      case 2:  return( logger::write( logger::sink::console, "[%s] %5d %x\n", m.s, m.i, (uint32_t)m.i ) );
+      case 3:  return( logger::write( logger::sink::terminal, "state %s\n", m.s ) );
+      default: return( logger::write( logger::sink::terminal, "tick\n" ) );
+    }
+}
+
+// snprintf of the same, string arguments cut to what a record keeps
+static void
+formatMessage( char *buf, size_t len, const message &m ) {
+    switch( m.type ) {
+      case 0:  snprintf( buf, len, "grab %d at %dmm\n", m.i, m.i / 7 ); break;
+      case 1:  snprintf( buf, len, "claw %.2f deg\n", m.f ); break;
+      case 2:  snprintf( buf, len, "[%.*s] %5d %x\n", SIM_LOG_TEXT, m.s, m.i, (uint32_t)m.i ); break;
+      case 3:  snprintf( buf, len, "state %.*s\n", SIM_LOG_TEXT, m.s ); break;
+      default: snprintf( buf, len, "tick\n" ); break;
+    }
+}
+
+static std::string
+printMessage( const message &m ) {
+    char buf[256];
+    formatMessage( buf, sizeof(buf), m );
+    return( buf );
+}
+
+// nS a call logging the list, a batch at a time with draining between
+static double
+timeLog( const std::vector<message> &list ) {
+    double ns = 0;
+    for( size_t i = 0; i < list.size(); i += 64 ) {
+      auto start = hostclock::now();
+      for( size_t j = i; j < i + 64 && j < list.size(); j++ )
+        logMessage( list[j] );
+      ns += bench::nsSince( start );
+      logger::drain();
+    }
+    return( ns / list.size() );
+}
+
+static void
+vprint( FILE *fp, const char *fmt, ... ) {
+    va_list args;
+    va_start( args, fmt );
+    vfprintf( fp, fmt, args );
+    va_end( args );
+}
+
+int main( int argc, char **argv ) {
+    int32_t   count = 100000;
+    uint32_t  seed  = 1;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        count = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-n messages] [--seed n]" );
+    }
+    if( count <= 0 )
+      bench::usage( argv[0], "[-n messages] [--seed n]" );
+
+    // check, a batch at a time so nothing is dropped
+    std::vector<message> list;
+    srand( seed );
+    for( int32_t i = 0; i < count; i++ )
+      list.push_back( randomMessage() );
+
+    char   *buf = NULL;
+    size_t  len = 0;
+    FILE   *mem = open_memstream( &buf, &len );
+    sim::logFile( mem );
+    for( int32_t i = 0; i < count; i++ ) {
+      logMessage( list[i] );
+      if( i % 64 == 63 )
+        logger::drain();
+    }
+    sim::logFile( NULL );
+    fclose( mem );
+
+    uint32_t dropped;
+    std::vector<std::string> back = readBack( buf, len, dropped );
+    int32_t bad = 0;
+    for( int32_t i = 0; i < count; i++ ) {
+      std::string want = printMessage( list[i] );
+      if( i >= (int32_t)back.size() || back[i] != want ) {
+        if( bad++ == 0 )
+          fprintf( stderr, "message %d is \"%s\", snprintf \"%s\"\n", i,
+                   i < (int32_t)back.size() ? back[i].c_str() : "(missing)", want.c_str() );
+      }
+    }
+    char detail[64];
+    snprintf( detail, sizeof(detail), "%d of %d differ, %u dropped, %.1f bytes each",
+              bad, count, dropped, (double)len / count );
+    bench::check( "read back against snprintf", bad == 0 && dropped == 0, detail );
+    free( buf );
+
+    // full, log with nothing draining until writes start failing
+    mem = open_memstream( &buf, &len );
+    sim::logFile( mem );
+    uint32_t before = logger::dropped();
+    int32_t  refused = 0;
+    std::vector<int32_t> taken;
+    for( int32_t i = 0; i < SIM_LOG_WORDS; i++ ) {
+      if( logMessage( list[i % count] ) )
+        taken.push_back( i % count );
+      else
+        refused++;
+    }
+    sim::logFile( NULL );
+    fclose( mem );
+    uint32_t total;
+    back = readBack( buf, len, total );
+    int32_t intact = 0;
+    for( size_t i = 0; i < back.size() && i < taken.size(); i++ )
+      if( back[i] == printMessage( list[taken[i]] ) )
+        intact++;
+    snprintf( detail, sizeof(detail), "%d taken, %d refused, %u counted, %d intact",
+              (int)taken.size(), refused, total - before, intact );
+    bench::check( "full ring drops and counts", refused > 0 && (int32_t)(total - before) == refused &&
+                  intact == (int32_t)taken.size(), detail );
+    free( buf );
+
+    // time, only the logging call is timed, draining is done between batches
+    FILE *null = fopen( "/dev/null", "w" );
+    sim::logFile( null );
+    double kinds[MESSAGE_KINDS];
+    for( int32_t k = 0; k < MESSAGE_KINDS; k++ ) {
+      std::vector<message> same = list;
+      for( message &m : same )
+        m.type = k;
+      kinds[k] = timeLog( same );
+    }
+    double logged = timeLog( list );
+    sim::logFile( NULL );
+
+    char text[256];
+    auto start = hostclock::now();
+    for( int32_t i = 0; i < count; i++ )
+      formatMessage( text, sizeof(text), list[i] );
+    double printed = bench::nsPerCall( start, count );
+
+    start = hostclock::now();
+    for( int32_t i = 0; i < count; i++ ) {
+      const message &m = list[i];
+      vprint( null, "grab %d at %dmm\n", m.i, m.i / 7 );
+      fflush( null );
+    }
+    double terminal = bench::nsPerCall( start, count );
+    fclose( null );
+
+    printf( "  %-32s %10s\n", "", "nS/call" );
+    for( int32_t k = 0; k < MESSAGE_KINDS; k++ ) {
+      std::string name = std::string( "logger::write " ) + _kinds[k];
+      printf( "  %-32s %10.1f\n", name.c_str(), kinds[k] );
+    }
+    printf( "  %-32s %10.1f\n", "logger::write mixed", logged );
+    printf( "  %-32s %10.1f\n", "snprintf mixed", printed );
+    printf( "  %-32s %10.1f\n", "vfprintf /dev/null", terminal );
+
+    return( bench::result() );
+}
@@ -0,0 +1,231 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_motion.cpp
+//    Description:  Checks and times profiled moves
+//
+//----------------------------------------------------------------------------
+
+// Three things, in order
+//
+//   check  - random moves are built and every table is checked against its
+//            limits, it must end on the distance and neither velocity,
+//            acceleration nor jerk may go past what was asked for
+//   time   - building a table against feeding one entry to a motor, which
+//            is all a tick of a profiled move costs
+//   moves  - a motor makes the same moves flat out, with a trapezoid and
+//            with an S-curve. Each must end on its target, and while the
+//            table is being fed the acceleration the motor reports must
+//            keep within BENCH_FOLLOW of the profile's, as must the jerk
+//            with an S-curve. A trapezoid has no jerk limit, it is held to
+//            the flat move's. The finish in position mode is left out, the
+//            motor breaking away from drag there jerks at a few rpm
+//
+// The moves ask for BENCH_VELOCITY, under what the motor reaches on the
+// bench's battery. Asked for more it runs out of volts at the top of the
+// ramp, and stops accelerating as abruptly as the windings let it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+#include "vex_motion.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+#define BENCH_PORT            0       // PORT1
+#define BENCH_VELOCITY        90      // pct
+#define BENCH_ACCELERATION    400     // pct per S
+#define BENCH_JERK            4000    // pct per S per S
+#define BENCH_TOLERANCE       1e-4    // of each limit, for rounding
+#define BENCH_FOLLOW          30      // pct past the limits the motor's own loop may go
+
+static const double _distances[] = { 90, 720 };   // deg
+static const char  *_kinds[]     = { "flat", "trapezoid", "s-curve" };
+#define BENCH_DISTANCES       2
+#define BENCH_KINDS           3
+
+namespace {
+  struct move {
+    int32_t             kind;
+    double              distance;
+    std::vector<double> velocity;     // rpm each tick the table is fed
+    double              time;         // mS
+    double              error;        // deg
+    bool                done;
+  };
+}
+
+static motor              _motor( PORT1 );
+static std::vector<move>  _moves;
+static int32_t            _current = -1;
+
+/*----------------------------------------------------------------------------*/
+/*  Table checks                                                              */
+/*----------------------------------------------------------------------------*/
+
+// how far past its limits a table goes, 0 if it keeps to them
+static double
+overLimits( const std::vector<sim::setpoint> &t, double d, double v, double a, double j ) {
+    const double dt   = SIM_POLL_INTERVAL / 1000.0;
+    double       over = fabs( t.back().position - d ) / std::max( fabs( d ), 1.0 );
+
+    for( size_t k = 0; k < t.size(); k++ ) {
+      over = std::max( over, fabs( t[k].velocity ) / v - 1 );
+      double prev = k ? t[k - 1].velocity : 0;
+      over = std::max( over, fabs( t[k].velocity - prev ) / dt / a - 1 );
+      if( j > 0 ) {
+        double prev2 = k > 1 ? t[k - 2].velocity : 0;
+        over = std::max( over, fabs( t[k].velocity - 2 * prev + prev2 ) / (dt * dt) / j - 1 );
+      }
+    }
+    // and back to a stop after the last entry
+    over = std::max( over, fabs( t.back().velocity ) / dt / a - 1 );
+    return( std::max( over, 0.0 ) );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program and sampling                                            */
+/*----------------------------------------------------------------------------*/
+
+static int
+benchMain() {
+    for( int32_t kind = 0; kind < BENCH_KINDS; kind++ ) {
+      for( int32_t d = 0; d < BENCH_DISTANCES; d++ ) {
+        move m = {};
+        m.kind     = kind;
+        m.distance = _distances[d] * (d % 2 ? -1 : 1);
+        _moves.push_back( m );
+
+        double   target = _motor.position( degrees ) + m.distance;
+        uint32_t start  = timer::system();
+        _current = _moves.size() - 1;
+        if( kind == 0 )
+          _moves.back().done = _motor.spinTo( target, degrees, BENCH_VELOCITY, velocityUnits::pct );
+        else
+          _moves.back().done = spinTo( _motor, target, degrees,
+                                 motionProfile( BENCH_VELOCITY, BENCH_ACCELERATION, kind == 2 ? BENCH_JERK : 0 ) );
+        _current = -1;
+        _moves.back().time  = timer::system() - start;
+        _moves.back().error = _motor.position( degrees ) - target;
+        task::sleep( 200 );
+      }
+    }
+    return( 0 );
+}
+
+// the motor's reported velocity once a tick, between polls, until a
+// profiled move is on its finish
+static void
+sample( void * ) {
+    if( _current >= 0 && (_moves[_current].kind == 0 || sim::motionActive( BENCH_PORT )) )
+      _moves[_current].velocity.push_back( sim::frameGet().ports[BENCH_PORT].motor.velocity );
+    sim::callAt( sim::now() + SIM_POLL_INTERVAL * 1000, sample, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    int32_t   count = 100000;
+    uint32_t  seed  = 1;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        count = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-n moves] [--seed n]" );
+    }
+    if( count <= 0 )
+      bench::usage( argv[0], "[-n moves] [--seed n]" );
+
+    // check, counts from a nudge to many turns and limits from gentle to
+    // ones the motor could never keep to
+    srand( seed );
+    std::vector<sim::setpoint> table;
+    int32_t bad   = 0;
+    double  worst = 0;
+    int64_t ticks = 0;
+    double  built = 0;
+    for( int32_t i = 0; i < count; i++ ) {
+      double d = (rand() % 2 ? -1 : 1) * exp( (rand() / (double)RAND_MAX) * 10 );
+      double v = 50 + rand() % 2000;
+      double a = 100 + rand() % 20000;
+      double j = (rand() % 4) ? 1000 + rand() % 200000 : 0;
+
+      auto start = hostclock::now();
+      sim::motionBuild( table, d, v, a, j );
+      built += bench::nsSince( start );
+      ticks += table.size();
+
+      double over = overLimits( table, d, v, a, j );
+      worst = std::max( worst, over );
+      if( over > BENCH_TOLERANCE && bad++ == 0 )
+        fprintf( stderr, "move %.1f at %.0f/%.0f/%.0f goes %.3g past its limits\n", d, v, a, j, over );
+    }
+    char detail[64];
+    snprintf( detail, sizeof(detail), "%d of %d past, worst %.2g", bad, count, worst );
+    bench::check( "tables within their limits", bad == 0, detail );
+
+    // time, feeding a motor is one table entry per tick
+    sim::start( benchMain );
+    sim::callAt( SIM_POLL_INTERVAL * 500, sample, NULL );
+
+    int32_t steps = 0;
+    sim::motionStart( BENCH_PORT, 1e6, 1e4, 1e4, 1e5 );
+    auto start = hostclock::now();
+    for( ; steps < count && sim::motionActive( BENCH_PORT ); steps++ )
+      sim::motionStep();
+    double step = bench::nsSince( start ) / steps;
+    sim::motionStop( BENCH_PORT );
+
+    printf( "  %-24s %10s\n", "", "nS" );
+    printf( "  %-24s %10.1f   %.1f ticks a move\n", "build, per move", built / count, (double)ticks / count );
+    printf( "  %-24s %10.1f\n", "build, per tick", built / ticks );
+    printf( "  %-24s %10.1f\n", "step, per tick", step );
+
+    // moves
+    sim::runFor( 60000 );
+
+    // rpm/S and rpm/S/S the profiles allow
+    const double rpm   = SIM_MOTOR_MAX_RPM / 100.0;
+    const double limit = BENCH_ACCELERATION * rpm * (1 + BENCH_FOLLOW / 100.0);
+    const double jerky = BENCH_JERK * rpm * (1 + BENCH_FOLLOW / 100.0);
+
+    printf( "  %-24s %10s %10s %10s %10s\n", "move", "mS", "error deg", "rpm/S", "rpm/S/S" );
+    double flat[BENCH_DISTANCES] = {};
+    for( size_t i = 0; i < _moves.size(); i++ ) {
+      move        &m  = _moves[i];
+      const double dt = SIM_POLL_INTERVAL / 1000.0;
+      double accel = 0, jerk = 0;
+      for( size_t k = 2; k < m.velocity.size(); k++ ) {
+        double a0 = (m.velocity[k - 1] - m.velocity[k - 2]) / dt;
+        double a1 = (m.velocity[k] - m.velocity[k - 1]) / dt;
+        accel = std::max( accel, fabs( a1 ) );
+        jerk  = std::max( jerk, fabs( a1 - a0 ) / dt );
+      }
+      if( m.kind == 0 )
+        flat[i % BENCH_DISTANCES] = jerk;
+
+      bool ok = m.done && fabs( m.error ) <= 2;
+      if( m.kind > 0 )
+        ok = ok && accel <= limit && jerk <= (m.kind == 2 ? jerky : flat[i % BENCH_DISTANCES]);
+
+      char name[32];
+      snprintf( name, sizeof(name), "%s %+.0f", _kinds[m.kind], m.distance );
+      bench::checkf( ok, "  %-24s %10.0f %10.2f %10.0f %10.0f", name, m.time, m.error, accel, jerk );
+    }
+    snprintf( detail, sizeof(detail), "%.0f rpm/S, %.0f rpm/S/S with an S-curve", limit, jerky );
+    printf( "  followed within %d%% of the limits, %s\n", BENCH_FOLLOW, detail );
+    return( bench::result() );
+}
@@ -0,0 +1,249 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_odometry.cpp
+//    Description:  Odometry against where a simulated robot really went
+//
+//----------------------------------------------------------------------------
+
+// A four motor drive, two motor_groups with the right side reversed, and a
+// gyro, drives a random course of straights, turns on the spot and arcs.
+// Each poll the robot is moved by what its wheels did, except that it
+// turns only BENCH_SCRUB of what the difference between the sides says, as
+// a skid steer robot does, and the gyro is set to where it really faces.
+// Two odometry ticks follow it, one fusing the gyro and one on the wheels
+// alone. Then
+//
+//   check    - at the end of the course the fused pose is within
+//              BENCH_ERROR of the distance driven and BENCH_HEADING of
+//              where the robot really is, the tick ran at its rate, and
+//              setPose is taken up by the next tick
+//   report   - how far off each pose is, the wheels alone to show what
+//              the gyro is for
+//   snapshot - one thread publishes poses as fast as it can while others
+//              read them, every pose read has to be one that was
+//              published, and the cost of a store and a load is reported
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "vex_sim.h"
+#include "vex_odometry.h"
+#include "bench.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+#define BENCH_GYRO            3       // PORT4
+#define BENCH_TRAVEL          200.0   // mm a wheel turn
+#define BENCH_TRACK           180.0   // mm
+#define BENCH_SCRUB           0.9     // of the turn the wheels say the robot makes
+#define BENCH_INTERVAL        10      // mS
+#define BENCH_ERROR           0.5     // pct of the distance driven
+#define BENCH_HEADING         0.5     // deg
+#define BENCH_READERS         3
+#define BENCH_STORES          2000000
+
+static motor          _leftFront( PORT1 ), _leftBack( PORT2 );
+static motor          _rightFront( PORT5, true ), _rightBack( PORT6, true );
+static motor_group    _left( _leftFront, _leftBack );
+static motor_group    _right( _rightFront, _rightBack );
+static gyro           _gyro( PORT4 );
+
+static odometry       _fused( _left, _right, _gyro, BENCH_TRAVEL, BENCH_TRACK, distanceUnits::mm );
+static odometry       _wheels( _left, _right, BENCH_TRAVEL, BENCH_TRACK, distanceUnits::mm );
+
+static int32_t        _seconds;
+
+// where the robot really is
+static double         _x, _y, _theta;       // mm, rad
+static double         _driven;              // mm
+static double         _lastLeft, _lastRight;
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static int
+benchMain() {
+    _fused.start( BENCH_INTERVAL );
+    _wheels.start( BENCH_INTERVAL );
+    uint32_t end = timer::system() + _seconds * 1000;
+
+    while( timer::system() < end ) {
+      double fwd  = bench::between( -80, 80 );
+      double turn = bench::between( -40, 40 );
+      switch( rand() % 3 ) {
+        case 0: turn = 0;   break;        // straight
+        case 1: fwd  = 0;   break;        // on the spot
+        default:            break;        // arc
+      }
+      _left.spin( forward, fwd + turn, percent );
+      _right.spin( forward, fwd - turn, percent );
+      task::sleep( (int32_t)fmin( bench::between( 300, 2000 ), end - timer::system() ) );
+    }
+    _left.stop( brake );
+    _right.stop( brake );
+    task::sleep( 500 );
+    return( 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot on the field, moved half way between polls                     */
+/*----------------------------------------------------------------------------*/
+
+static void
+field( void * ) {
+    // the front motors' shafts, the right side turns the other way
+    double left  = sim::portGet( 0 )->motor.position / SIM_MOTOR_COUNTS * BENCH_TRAVEL;
+    double right = -sim::portGet( 4 )->motor.position / SIM_MOTOR_COUNTS * BENCH_TRAVEL;
+    double dl    = left - _lastLeft;
+    double dr    = right - _lastRight;
+    _lastLeft    = left;
+    _lastRight   = right;
+
+    double d      = (dl + dr) / 2;
+    double dtheta = (dr - dl) / BENCH_TRACK * BENCH_SCRUB;
+    _x      += d * cos( _theta + dtheta / 2 );
+    _y      += d * sin( _theta + dtheta / 2 );
+    _theta  += dtheta;
+    _driven += fabs( d );
+
+    double dt = SIM_POLL_INTERVAL / 1000.0;
+    sim::setGyro( BENCH_GYRO, _theta * 180 / M_PI, dtheta * 180 / M_PI / dt );
+    sim::callAt( sim::now() + SIM_POLL_INTERVAL * 1000, field, NULL );
+}
+
+static void
+report( const char *name, const odometry &o, double *off, double *turned ) {
+    odometry::pose p = o.get();
+    *off    = hypot( p.x - _x, p.y - _y );
+    *turned = fabs( remainder( p.heading - _theta * 180 / M_PI, 360 ) );
+    printf( "  %-10s %10.1f %10.1f %10.2f %10.1f mm %8.2f deg\n", name, p.x, p.y, p.heading, *off, *turned );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The snapshot under threads                                                */
+/*----------------------------------------------------------------------------*/
+
+static poseSnapshot        _snapshot;
+static std::atomic<bool>   _storing;
+
+static void
+reader( uint64_t *loads, uint64_t *torn, double *ns ) {
+    auto start = hostclock::now();
+    while( _storing.load( std::memory_order_relaxed ) ) {
+      poseSnapshot::pose p = _snapshot.load();
+      float k = (float)p.time;
+      if( p.x != k || p.y != 2 * k || p.heading != -k )
+        (*torn)++;
+      (*loads)++;
+    }
+    *ns = bench::nsSince( start );
+}
+
+static void
+snapshot() {
+    std::vector<std::thread> threads;
+    uint64_t                 loads[BENCH_READERS] = {}, torn[BENCH_READERS] = {};
+    double                   ns[BENCH_READERS] = {};
+
+    _storing = true;
+    for( int32_t k = 0; k < BENCH_READERS; k++ )
+      threads.emplace_back( reader, &loads[k], &torn[k], &ns[k] );
+
+    auto start = hostclock::now();
+    for( uint32_t k = 1; k <= BENCH_STORES; k++ ) {
+      poseSnapshot::pose p = { (float)k, (float)(2 * k), -(float)k, k };
+      _snapshot.store( p );
+    }
+    double store = bench::nsSince( start ) / BENCH_STORES;
+    _storing = false;
+    for( auto &t : threads )
+      t.join();
+
+    // the time every reader spent over every load they made, so a reader
+    // that hardly got a look in counts for as little as it did
+    uint64_t all = 0, bad = 0;
+    double   spent = 0;
+    for( int32_t k = 0; k < BENCH_READERS; k++ ) {
+      all   += loads[k];
+      bad   += torn[k];
+      spent += ns[k];
+    }
+    double load = all ? spent / all : 0;
+    printf( "pose snapshot, 1 writer, %d readers, %d stores\n", BENCH_READERS, BENCH_STORES );
+    printf( "  %-40s %10.1f   nS\n", "a store", store );
+    printf( "  %-40s %10.1f   nS, %llu loads\n", "a load", load, (unsigned long long)all );
+
+    char detail[64];
+    snprintf( detail, sizeof(detail), "%llu of %llu", (unsigned long long)bad, (unsigned long long)all );
+    bench::check( "loads that were not a published pose", all > 0 && bad == 0, detail );
+    snprintf( detail, sizeof(detail), "%u", _snapshot.count() );
+    bench::check( "poses published", _snapshot.count() == BENCH_STORES, detail );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    uint32_t seed = 1;
+    _seconds = 120;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        _seconds = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+        seed = strtoul( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-t seconds] [--seed n]" );
+    }
+    if( _seconds <= 0 )
+      bench::usage( argv[0], "[-t seconds] [--seed n]" );
+    srand( seed );
+
+    // a robot's worth of mass on each motor and the floor dragging on it
+    sim::motorLoad robot = {};
+    robot.inertia  = 0.004;
+    robot.friction = 0.02;
+    for( int32_t i : { 0, 1, 4, 5 } )
+      sim::setMotorLoad( i, robot );
+
+    sim::start( benchMain );
+    sim::callAt( SIM_POLL_INTERVAL * 500, field, NULL );
+    sim::runFor( _seconds * 1000 + 1000 );
+
+    printf( "odometry over a %dS random course, %.0fmm driven, turns scrub to %.0f%%\n", _seconds, _driven, BENCH_SCRUB * 100 );
+    printf( "  %-10s %10s %10s %10s %13s %12s\n", "", "x", "y", "heading", "off by", "heading off" );
+    printf( "  %-10s %10.1f %10.1f %10.2f\n", "robot", _x, _y, remainder( _theta * 180 / M_PI, 360 ) );
+    double off, turned, wheelsOff, wheelsTurned;
+    report( "gyro", _fused, &off, &turned );
+    report( "wheels", _wheels, &wheelsOff, &wheelsTurned );
+
+    char detail[96];
+    snprintf( detail, sizeof(detail), "%.1fmm, %.3f%% of the distance", off, off / _driven * 100 );
+    bench::check( "gyro pose against the robot", off <= _driven * BENCH_ERROR / 100 && turned <= BENCH_HEADING, detail );
+
+    // a tick every interval from the start, none lost or doubled
+    uint32_t want = (_seconds * 1000 + 1000) / BENCH_INTERVAL;
+    snprintf( detail, sizeof(detail), "%u ticks, %u due", _fused.ticks(), want );
+    bench::check( "ticks at the interval", _fused.ticks() + 1 >= want && _fused.ticks() <= want + 1, detail );
+
+    // the robot has stopped, so the next tick should leave it where it was put
+    _wheels.setPose( 1000, 500, 90, distanceUnits::mm, rotationUnits::deg );
+    sim::runFor( 2 * BENCH_INTERVAL );
+    odometry::pose p = _wheels.get();
+    snprintf( detail, sizeof(detail), "%.1f, %.1f at %.2f deg", p.x, p.y, p.heading );
+    bench::check( "setPose while running", fabs( p.x - 1000 ) < 0.1 && fabs( p.y - 500 ) < 0.1 && fabs( p.heading - 90 ) < 0.01, detail );
+
+    snapshot();
+    return( bench::result() );
+}
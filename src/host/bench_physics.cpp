@@ -0,0 +1,275 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_physics.cpp
+//    Description:  Checks and times the motor model
+//
+//----------------------------------------------------------------------------
+
+// Three things, in order
+//
+//   check    - a bare motor is run through free speed, the velocity loop,
+//              a stall against a hard stop, the max torque setting, a heavy
+//              load, a position move and a stall held until it overheats
+//              and then left to cool, and what it reports is compared with
+//              what the constants in vex_sim.h say it should
+//   model    - how many seconds of one motor the model runs per second of
+//              host time, stepped a poll at a time as the device poll does
+//   runtime  - a whole program under the virtual clock, four drive motors
+//              and a claw that closes on a hard stop, holds for a moment
+//              and opens again, for as long as asked, and how much faster
+//              than real time that ran
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+#define BENCH_CLAW_PORT       7       // PORT8
+#define BENCH_CLAW_TRAVEL     90      // deg between the stops
+#define BENCH_CLAW_HOLD       20      // pct torque once closed
+
+static motor              _leftFront( PORT1 ), _leftBack( PORT2 );
+static motor              _rightFront( PORT5, true ), _rightBack( PORT6, true );
+static motor              _claw( PORT8 );
+
+static int32_t            _grabs;
+
+/*----------------------------------------------------------------------------*/
+/*  Model checks                                                              */
+/*----------------------------------------------------------------------------*/
+
+static sim::port
+bare() {
+    sim::port p;
+    memset( &p, 0, sizeof(p) );
+    p.type              = kDeviceTypeMotorSensor;
+    p.motor.maxTorque   = 100;
+    p.motor.temperature = SIM_MOTOR_AMBIENT;
+    return( p );
+}
+
+static void
+command( sim::motorState &c, sim::motorMode mode, double value, double target = 0 ) {
+    c.mode    = mode;
+    c.command = value;
+    c.target  = target;
+}
+
+// run for mS a poll at a time, as the device poll does
+static void
+run( sim::port &p, const sim::motorState &c, int32_t ms ) {
+    for( int32_t t = 0; t < ms; t += SIM_POLL_INTERVAL )
+      sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+}
+
+static void
+check( const char *name, double value, double low, double high, const char *units ) {
+    bench::checkf( value >= low && value <= high, "  %-32s %10.3f   %-6s", name, value, units );
+}
+
+static void
+flag( const char *name, const sim::port &p, uint8_t mask, bool set ) {
+    bench::checkf( ((p.motor.flags & mask) != 0) == set, "  %-32s %10s   %-6s", name, set ? "set" : "clear", "" );
+}
+
+// mS until the motor passes 90% of rpm
+static int32_t
+riseTime( sim::port &p, const sim::motorState &c, double rpm ) {
+    int32_t t = 0;
+    while( p.motor.velocity < rpm * 0.9 && t < 10000 ) {
+      sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+      t += SIM_POLL_INTERVAL;
+    }
+    return( t );
+}
+
+static void
+modelChecks() {
+    sim::motorState c = {};
+    c.maxTorque = 100;
+
+    printf( "motor model\n" );
+
+    // free speed, full battery straight across the windings
+    sim::port p = bare();
+    command( c, sim::motorMode::voltage, SIM_MOTOR_VOLTS );
+    run( p, c, 2000 );
+    check( "free speed at full voltage", p.motor.velocity, SIM_MOTOR_MAX_RPM * 0.95, SIM_MOTOR_MAX_RPM, "rpm" );
+    check( "free running current", p.motor.current, 0, 0.1, "A" );
+
+    // the velocity loop holds a speed with the friction taken up
+    command( c, sim::motorMode::velocity, 50 );
+    run( p, c, 1000 );
+    check( "velocity loop at 50%", p.motor.velocity, SIM_MOTOR_MAX_RPM * 0.49, SIM_MOTOR_MAX_RPM * 0.51, "rpm" );
+    flag( "ZEROVEL while turning", p, VEXIQ_MOTOR_ZEROVEL_FLAG, false );
+
+    // against a hard stop the firmware limits the current
+    p = bare();
+    p.load.stops = true;
+    p.load.low   = -1;
+    p.load.high  = 1;
+    command( c, sim::motorMode::velocity, 100 );
+    run( p, c, 500 );
+    check( "stall current", p.motor.current, SIM_MOTOR_MAX_AMPS * 0.99, SIM_MOTOR_MAX_AMPS * 1.01, "A" );
+    flag( "CURLIMIT when stalled", p, VEXIQ_MOTOR_CURLIMIT_FLAG, true );
+    flag( "ZEROVEL when stalled", p, VEXIQ_MOTOR_ZEROVEL_FLAG, true );
+
+    c.maxTorque = 50;
+    run( p, c, 500 );
+    check( "stall current at 50% torque", p.motor.current, SIM_MOTOR_MAX_AMPS * 0.49, SIM_MOTOR_MAX_AMPS * 0.51, "A" );
+    c.maxTorque = 100;
+
+    // the same loop takes longer to get a heavy load up to speed
+    p = bare();
+    int32_t light = riseTime( p, c, SIM_MOTOR_MAX_RPM );
+    p = bare();
+    p.load.inertia = SIM_MOTOR_INERTIA * 10;
+    int32_t heavy = riseTime( p, c, SIM_MOTOR_MAX_RPM );
+    check( "rise to 90%, no load", light, 10, 200, "mS" );
+    check( "rise to 90%, 10x inertia", heavy, light * 2, 2000, "mS" );
+
+    // a constant load the loop has to take up, 10% of stall torque
+    p = bare();
+    p.load.torque = SIM_MOTOR_STALL_NM * 0.1;
+    command( c, sim::motorMode::velocity, 50 );
+    run( p, c, 1000 );
+    check( "velocity loop under load", p.motor.velocity, SIM_MOTOR_MAX_RPM * 0.49, SIM_MOTOR_MAX_RPM * 0.51, "rpm" );
+
+    // a turn in position mode ends on the target
+    p = bare();
+    command( c, sim::motorMode::position, 50, SIM_MOTOR_COUNTS );
+    run( p, c, 2000 );
+    check( "position move of 1 turn", p.motor.position / SIM_MOTOR_COUNTS * 360, 358, 362, "deg" );
+    flag( "ZEROPOS on target", p, VEXIQ_MOTOR_ZEROPOS_FLAG, true );
+
+    // held stalled it heats up, trips overtemp and is limited harder, left
+    // to cool it clears again
+    p = bare();
+    p.load.stops = true;
+    p.load.low   = -1;
+    p.load.high  = 1;
+    command( c, sim::motorMode::velocity, 100 );
+    int32_t hot = 0;
+    while( !(p.motor.flags & VEXIQ_MOTOR_OVERTEMP_FLAG) && hot < 3600000 ) {
+      sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+      hot += SIM_POLL_INTERVAL;
+    }
+    check( "stalled until overtemp", hot / 1000.0, 30, 600, "S" );
+    run( p, c, 500 );
+    check( "stall current when hot", p.motor.current, SIM_MOTOR_MAX_AMPS * SIM_MOTOR_HOT_LIMIT / 100 * 0.99,
+                                                      SIM_MOTOR_MAX_AMPS * SIM_MOTOR_HOT_LIMIT / 100 * 1.01, "A" );
+
+    command( c, sim::motorMode::coast, 0 );
+    int32_t cool = 0;
+    while( (p.motor.flags & VEXIQ_MOTOR_OVERTEMP_FLAG) && cool < 3600000 ) {
+      sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+      cool += SIM_POLL_INTERVAL;
+    }
+    check( "coasting until it clears", cool / 1000.0, 1, 600, "S" );
+    check( "temperature when cleared", p.motor.temperature, SIM_MOTOR_AMBIENT, SIM_MOTOR_COOLED, "C" );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static int
+drive() {
+    // slow turns one way then the other, so the drive is always changing speed
+    for( int32_t k = 0; ; k++ ) {
+      double fwd  = 60 * sin( k * 0.01 );
+      double turn = 30 * sin( k * 0.023 );
+      _leftFront.spin( forward, fwd + turn, percent );
+      _leftBack.spin( forward, fwd + turn, percent );
+      _rightFront.spin( forward, fwd - turn, percent );
+      _rightBack.spin( forward, fwd - turn, percent );
+      task::sleep( 20 );
+    }
+    return( 0 );
+}
+
+static int
+benchMain() {
+    task t( drive );
+
+    // close onto the stop, hold it a moment at less torque, open. Kept up
+    // for long enough the claw overheats and closes at half the current
+    _claw.setTimeout( 3000, msec );
+    for( ;; ) {
+      _claw.spin( reverse, 50, percent );
+      task::sleep( 300 );
+      _claw.setMaxTorque( BENCH_CLAW_HOLD, percent );
+      _claw.stop( brakeType::hold );
+      _grabs++;
+      task::sleep( 100 );
+      _claw.setMaxTorque( 100, percent );
+      _claw.spinTo( 0, degrees, 100, velocityUnits::pct );
+    }
+    return( 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    int32_t seconds = 3600;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        seconds = strtol( argv[++i], NULL, 0 );
+      else
+        bench::usage( argv[0], "[-t seconds]" );
+    }
+    if( seconds <= 0 )
+      bench::usage( argv[0], "[-t seconds]" );
+
+    modelChecks();
+
+    // model, one motor a poll at a time for the same virtual time
+    sim::port       p = bare();
+    sim::motorState c = {};
+    c.maxTorque = 100;
+    command( c, sim::motorMode::velocity, 50 );
+    int32_t polls = seconds * 1000 / SIM_POLL_INTERVAL;
+    auto start = hostclock::now();
+    for( int32_t k = 0; k < polls; k++ ) {
+      c.command = (k & 256) ? 50 : -50;
+      sim::motorModel( p, c, SIM_MOTOR_VOLTS, SIM_POLL_INTERVAL / 1000.0 );
+    }
+    double host = std::chrono::duration<double>( hostclock::now() - start ).count();
+    printf( "  %-32s %10.1f   nS a poll, %.0fx real time a motor\n", "model", host * 1e9 / polls, seconds / host );
+
+    // runtime, the claw closes on stops either side of where it starts
+    sim::start( benchMain );
+    sim::motorLoad claw = {};
+    claw.inertia = SIM_MOTOR_INERTIA;
+    claw.stops   = true;
+    claw.low     = -BENCH_CLAW_TRAVEL / 360.0 * SIM_MOTOR_COUNTS;
+    claw.high    = BENCH_CLAW_TRAVEL / 360.0 * SIM_MOTOR_COUNTS;
+    sim::setMotorLoad( BENCH_CLAW_PORT, claw );
+
+    sim::motorLoad wheels = {};
+    wheels.inertia  = SIM_MOTOR_INERTIA * 4;
+    wheels.friction = 0.02;
+    for( int32_t port : { 0, 1, 4, 5 } )
+      sim::setMotorLoad( port, wheels );
+
+    start = hostclock::now();
+    sim::runFor( seconds * 1000 );
+    host = std::chrono::duration<double>( hostclock::now() - start ).count();
+    printf( "  %-32s %10.3f   S for %dS, %.0fx real time, %d grabs\n", "runtime", host, seconds, seconds / host, _grabs );
+
+    if( _grabs == 0 )
+      bench::failed++;
+    return( bench::result() );
+}
@@ -0,0 +1,282 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_telemetry.cpp
+//    Description:  Checks and times the telemetry recorder
+//
+//----------------------------------------------------------------------------
+
+// A drive of four motors, two of them in a motor_group, and a claw are
+// recorded while the drive weaves about and the claw opens and closes, for
+// long enough that the ring wraps. Then
+//
+//   check    - the right number of samples are held and lost, every motor
+//              has one sample a tick and the ticks are the interval apart,
+//              the oldest held is the one that should be, and the CSV and
+//              binary files read back to what get returns
+//   time     - a tick is taken over and over with every motor added, and
+//              the cost a tick and a sample and any allocation made is
+//              reported
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+using bench::hostclock;
+
+#define BENCH_MOTORS          5
+#define BENCH_TICKS           100000
+
+static motor              _leftFront( PORT1 ), _leftBack( PORT2 );
+static motor              _rightFront( PORT5, true ), _rightBack( PORT6, true );
+static motor              _claw( PORT8 );
+static motor_group        _right( _rightFront, _rightBack );
+
+
+// allocations made while counting, anything the recorder does would show here
+static bool               _counting;
+static uint32_t           _allocations;
+
+void *
+operator new( size_t size ) {
+    if( _counting )
+      _allocations++;
+    void *p = malloc( size ? size : 1 );
+    if( p == NULL )
+      throw std::bad_alloc();
+    return( p );
+}
+
+void
+operator delete( void *p ) noexcept {
+    free( p );
+}
+
+void
+operator delete( void *p, size_t ) noexcept {
+    free( p );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static int
+drive() {
+    for( int32_t k = 0; ; k++ ) {
+      double fwd  = 60 * sin( k * 0.01 );
+      double turn = 30 * sin( k * 0.023 );
+      _leftFront.spin( forward, fwd + turn, percent );
+      _leftBack.spin( forward, fwd + turn, percent );
+      _right.spin( forward, fwd - turn, percent );
+      task::sleep( 20 );
+    }
+    return( 0 );
+}
+
+static int
+benchMain() {
+    task t( drive );
+    for( ;; ) {
+      _claw.spinFor( -60, degrees, 50, velocityUnits::pct );
+      _claw.spinTo( 0, degrees, 50, velocityUnits::pct );
+    }
+    return( 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Checks                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static bool
+same( const telemetry::sample &a, const telemetry::sample &b ) {
+    return( a.time == b.time && a.port == b.port && a.position == b.position && a.velocity == b.velocity &&
+            a.current == b.current && a.voltage == b.voltage && a.torque == b.torque && a.temperature == b.temperature );
+}
+
+// what the CSV row says against the sample, to the places it prints
+static bool
+matches( const telemetry::sample &s, uint32_t time, uint32_t port, const double *v ) {
+    const double f[6]   = { s.position, s.velocity, s.current, s.voltage, s.torque, s.temperature };
+    const double tol[6] = { 0.0005, 0.0005, 0.00005, 0.00005, 0.000005, 0.005 };
+    if( time != s.time || port != s.port + 1u )
+      return( false );
+    for( int32_t i = 0; i < 6; i++ )
+      if( fabs( f[i] - v[i] ) > tol[i] * 1.01 )
+        return( false );
+    return( true );
+}
+
+static void
+checks( uint32_t ticks, uint32_t interval, const char *dir ) {
+    char     detail[96];
+    uint64_t total = (uint64_t)ticks * BENCH_MOTORS;
+    uint32_t held  = (uint32_t)std::min<uint64_t>( total, SIM_TELEMETRY_SAMPLES );
+
+    printf( "telemetry, %d motors every %umS, %u ticks\n", BENCH_MOTORS, interval, ticks );
+    snprintf( detail, sizeof(detail), "%u held, %u lost", telemetry::count(), telemetry::lost() );
+    bench::check( "samples held and lost", telemetry::count() == held && telemetry::lost() == total - held, detail );
+
+    // a tick is every motor in the order added, at one time
+    telemetry::sample s, prev = {};
+    uint32_t bad = 0;
+    uint32_t first = (uint32_t)((total - held) / BENCH_MOTORS) * interval;
+    for( uint32_t i = 0; telemetry::get( i, s ); i++ ) {
+      uint64_t n    = total - held + i;
+      uint32_t time = (uint32_t)(n / BENCH_MOTORS) * interval;
+      if( s.time != time )
+        bad++;
+      if( i > 0 && n % BENCH_MOTORS != 0 && s.time != prev.time )
+        bad++;
+      prev = s;
+    }
+    telemetry::get( 0, s );
+    snprintf( detail, sizeof(detail), "oldest at %umS, %u out of step", s.time, bad );
+    bench::check( "one sample a motor a tick", bad == 0 && s.time == first, detail );
+
+    // binary, read back as logdecode does
+    char path[256];
+    snprintf( path, sizeof(path), "%s/bench_telemetry.bin", dir );
+    bad = 0;
+    if( !telemetry::save( path, telemetry::fileType::binary ) )
+      bad = held;
+    else {
+      FILE    *fp = fopen( path, "rb" );
+      char     magic[sizeof(SIM_TELEMETRY_MAGIC)] = "";
+      uint32_t header[2] = {};
+      uint8_t  rec[SIM_TELEMETRY_RECORD];
+      if( fp == NULL || fread( magic, 1, strlen( SIM_TELEMETRY_MAGIC ), fp ) != strlen( SIM_TELEMETRY_MAGIC ) ||
+          strcmp( magic, SIM_TELEMETRY_MAGIC ) != 0 || fread( header, sizeof(header), 1, fp ) != 1 ||
+          header[0] != held || header[1] != total - held )
+        bad = held;
+      for( uint32_t i = 0; bad == 0 && i < held; i++ ) {
+        telemetry::sample r;
+        if( fread( rec, sizeof(rec), 1, fp ) != 1 ) {
+          bad = held - i;
+          break;
+        }
+        sim::telemetryUnpack( rec, r );
+        telemetry::get( i, s );
+        if( !same( r, s ) )
+          bad++;
+      }
+      if( fp )
+        fclose( fp );
+      remove( path );
+    }
+    snprintf( detail, sizeof(detail), "%u bytes a sample, %u differ", SIM_TELEMETRY_RECORD, bad );
+    bench::check( "binary file reads back", bad == 0, detail );
+
+    // CSV
+    snprintf( path, sizeof(path), "%s/bench_telemetry.csv", dir );
+    bad = 0;
+    if( !telemetry::save( path, telemetry::fileType::csv ) )
+      bad = held;
+    else {
+      FILE    *fp = fopen( path, "r" );
+      char     line[256];
+      uint32_t rows = 0;
+      if( fp == NULL || fgets( line, sizeof(line), fp ) == NULL || strcmp( line, SIM_TELEMETRY_HEADER ) != 0 )
+        bad = held;
+      while( bad == 0 && fgets( line, sizeof(line), fp ) ) {
+        uint32_t time, port;
+        double   v[6];
+        if( sscanf( line, "%u,%u,%lf,%lf,%lf,%lf,%lf,%lf", &time, &port, v, v + 1, v + 2, v + 3, v + 4, v + 5 ) != 8 ||
+            !telemetry::get( rows, s ) || !matches( s, time, port, v ) )
+          bad++;
+        rows++;
+      }
+      if( rows != held )
+        bad += held > rows ? held - rows : rows - held;
+      if( fp )
+        fclose( fp );
+      remove( path );
+    }
+    snprintf( detail, sizeof(detail), "%u differ", bad );
+    bench::check( "CSV file reads back", bad == 0, detail );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Timing                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void
+timing() {
+    std::vector<double> ns;
+    ns.reserve( BENCH_TICKS );
+
+    _counting = true;
+    auto all = hostclock::now();
+    for( int32_t k = 0; k < BENCH_TICKS; k++ ) {
+      auto start = hostclock::now();
+      sim::telemetrySample();
+      ns.push_back( bench::nsSince( start ) );
+    }
+    double host = bench::nsSince( all );
+    _counting = false;
+
+    // the vector was reserved, so anything counted came from sampling
+    std::sort( ns.begin(), ns.end() );
+    printf( "telemetry tick, %d motors, %d ticks\n", BENCH_MOTORS, BENCH_TICKS );
+    printf( "  %-40s %8.1f %8.1f %8.1f   nS p50/p99/max\n", "a tick", ns[BENCH_TICKS / 2], ns[BENCH_TICKS * 99 / 100], ns.back() );
+    printf( "  %-40s %8.1f   nS, timer overhead included above\n", "a sample, on average", host / BENCH_TICKS / BENCH_MOTORS );
+    char detail[32];
+    snprintf( detail, sizeof(detail), "%u", _allocations );
+    bench::check( "allocations while sampling", _allocations == 0, detail );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    int32_t     seconds  = 300;
+    int32_t     interval = 10;
+    const char *dir      = "/tmp";
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        seconds = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "-i" ) == 0 && i + 1 < argc )
+        interval = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--dir" ) == 0 && i + 1 < argc )
+        dir = argv[++i];
+      else
+        bench::usage( argv[0], "[-t seconds] [-i interval_ms] [--dir path]" );
+    }
+    if( seconds <= 0 || interval <= 0 )
+      bench::usage( argv[0], "[-t seconds] [-i interval_ms] [--dir path]" );
+
+    telemetry::add( _leftFront );
+    telemetry::add( _leftBack );
+    telemetry::add( _right );
+    telemetry::add( _claw );
+
+    // started before the run so the first tick is at 0, the last one due
+    // at the end of the run goes too
+    sim::start( benchMain );
+    telemetry::start( interval );
+    sim::runFor( seconds * 1000 );
+    telemetry::stop();
+
+    telemetry::sample last = {};
+    telemetry::get( telemetry::count() - 1, last );
+    uint32_t ticks = last.time / interval + 1;
+
+    checks( ticks, interval, dir );
+    if( ticks < (uint32_t)(seconds * 1000 / interval) )
+      bench::check( "ticks for the whole run", false, "" );
+    timing();
+    return( bench::result() );
+}
@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_thermal.cpp
+//    Description:  code.c++'s claw heat estimate and derating against the model
+//
+//----------------------------------------------------------------------------
+
+// Two claws do the same thing side by side off AxisD, code.c++'s claw run
+// unmodified, which estimates its temperature and derates itself, and a
+// plain one on PORT9 driven by a changed handler. First the driver pushes
+// both on their stops from cold until the plain one overheats, or for
+// BENCH_STALL seconds, then grabs and lets go over and over, pushing for
+// BENCH_PUSH and resting for BENCH_REST, as in a long match.
+//
+// code.c++ estimates with the data sheet's winding and thermal constants,
+// and both motors are given a spread off those, so the estimate is checked
+// against a motor it does not know exactly. Every poll code.c++'s estimate
+// is compared with the model's own temperature, which it never sees. Then
+//
+//   check    - the estimate stays within BENCH_ERROR of the model, the time
+//              to overtemp predicted BENCH_SETTLE seconds into the stall is
+//              within BENCH_PREDICT pct of when the plain claw's flag came
+//              up, the plain claw does overheat and code.c++'s never does
+//   report   - for each the hottest it got, the time it spent with the
+//              firmware halving its torque and the torque it pushed with
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+extern "C" int vexUserMain( void );
+
+// what code.c++ works out, see clawHeat
+extern double         clawTemperature;
+extern double         clawTimeToHot();
+
+#define BENCH_AXIS            3       // AxisD
+#define BENCH_DERATED         7       // PORT8, code.c++'s claw
+#define BENCH_PLAIN           8       // PORT9
+#define BENCH_STALL           400     // S at most pushing from cold
+#define BENCH_CHECK           100     // mS between looks at the plain claw
+#define BENCH_SETTLE          20      // S into it the time to overtemp is taken
+#define BENCH_PUSH            15000   // mS each grab
+#define BENCH_OPEN            500     // mS
+#define BENCH_REST            5000    // mS after opening
+#define BENCH_PREDICT         10      // pct
+#define BENCH_ERROR           0.5     // C
+
+static motor          _plain( PORT9 );
+static controller     _controller;
+
+namespace {
+  struct claw {
+    int32_t     index;
+    double      hottest;      // C, model
+    double      hotTime;      // S with the overtemp flag up
+    double      pushTime;     // S pushing
+    double      torque;       // Nm S while pushing
+    double      firstHot;     // S, when the flag first came up
+  };
+}
+
+static claw           _claws[2] = { { BENCH_PLAIN }, { BENCH_DERATED } };
+static double         _error;         // C, worst of estimate against model
+static double         _predicted;     // S, when the claws should overheat
+static bool           _pushing;
+static sim::usec_t    _next;          // when the stick next moves
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static void
+plainMovement() {
+    _plain.spin( forward, _controller.AxisD.position( percent ), percent );
+}
+
+// code.c++ with a plain claw beside it
+static int
+benchMain() {
+    _controller.AxisD.changed( plainMovement );
+    return( vexUserMain() );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The driver, pushing, opening and resting                                  */
+/*----------------------------------------------------------------------------*/
+
+static void
+driver( void * ) {
+    sim::usec_t t = sim::now();
+
+    // pushing from cold until the plain claw overheats
+    if( t == SIM_POLL_INTERVAL * 500 ) {
+      _pushing = true;
+      sim::setAxis( BENCH_AXIS, -100 );
+      _next = t + BENCH_CHECK * 1000;
+    }
+    else
+    if( _claws[0].hotTime == 0 && t < BENCH_STALL * 1000000LL ) {
+      _next = t + BENCH_CHECK * 1000;
+    }
+    else
+    if( _pushing ) {
+      _pushing = false;
+      sim::setAxis( BENCH_AXIS, 100 );
+      _next = t + BENCH_OPEN * 1000;
+    }
+    else
+    if( _controller.AxisD.position( percent ) != 0 ) {
+      sim::setAxis( BENCH_AXIS, 0 );
+      _next = t + BENCH_REST * 1000;
+    }
+    else {
+      _pushing = true;
+      sim::setAxis( BENCH_AXIS, -100 );
+      _next = t + BENCH_PUSH * 1000;
+    }
+    sim::callAt( _next, driver, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Compared half way between polls                                           */
+/*----------------------------------------------------------------------------*/
+
+static void
+sample( void * ) {
+    const double dt = SIM_POLL_INTERVAL / 1000.0;
+    sim::usec_t  t  = sim::now();
+
+    for( int32_t k = 0; k < 2; k++ ) {
+      claw                  &c = _claws[k];
+      const sim::motorState &s = sim::portGet( c.index )->motor;
+      c.hottest = fmax( c.hottest, s.temperature );
+      if( s.flags & VEXIQ_MOTOR_OVERTEMP_FLAG ) {
+        if( c.hotTime == 0 )
+          c.firstHot = t / 1e6;
+        c.hotTime += dt;
+      }
+      if( _pushing ) {
+        c.pushTime += dt;
+        c.torque   += fabs( s.current ) / SIM_MOTOR_MAX_AMPS * SIM_MOTOR_STALL_NM * dt;
+      }
+    }
+
+    // code.c++ seeds its estimate on its first tick
+    if( t > SIM_POLL_INTERVAL * 1000 * 10 )
+      _error = fmax( _error, fabs( clawTemperature - sim::portGet( BENCH_DERATED )->motor.temperature ) );
+    if( _predicted == 0 && t >= SIM_POLL_INTERVAL * 500 + BENCH_SETTLE * 1000000LL )
+      _predicted = t / 1e6 + clawTimeToHot();
+    sim::callAt( t + SIM_POLL_INTERVAL * 1000, sample, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Report                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int main( int argc, char **argv ) {
+    const char       *args    = "[-t seconds] [--spread ohms,mass,loss pct]";
+    int32_t           seconds = 600;
+    sim::motorSpread  spread  = { 10, -10, 10 };
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 && i + 1 < argc )
+        seconds = strtol( argv[++i], NULL, 0 );
+      else
+      if( strcmp( argv[i], "--spread" ) == 0 && i + 1 < argc ) {
+        if( sscanf( argv[++i], "%lf,%lf,%lf", &spread.ohms, &spread.heatMass, &spread.heatLoss ) != 3 )
+          bench::usage( argv[0], args );
+      }
+      else
+        bench::usage( argv[0], args );
+    }
+    if( seconds <= BENCH_STALL )
+      bench::usage( argv[0], args );
+
+    // claws closed on something solid a quarter turn in, on motors a little
+    // off the data sheet
+    sim::motorLoad stop = {};
+    stop.inertia = 0.002;
+    stop.stops   = true;
+    stop.low     = -SIM_MOTOR_COUNTS / 4;
+    stop.high    = SIM_MOTOR_COUNTS * 100;
+    for( int32_t k = 0; k < 2; k++ ) {
+      sim::setMotorLoad( _claws[k].index, stop );
+      sim::setMotorSpread( _claws[k].index, spread );
+    }
+
+    sim::start( benchMain );
+    sim::callAt( SIM_POLL_INTERVAL * 500, driver, NULL );
+    sim::callAt( SIM_POLL_INTERVAL * 500, sample, NULL );
+    sim::runFor( seconds * 1000 );
+
+    printf( "two claws, pushing from cold until one is hot then %dmS grabs every %dmS, %dS in all\n",
+            BENCH_PUSH, BENCH_PUSH + BENCH_OPEN + BENCH_REST, seconds );
+    printf( "  motors %+.0f%% ohms, %+.0f%% heat mass, %+.0f%% heat loss off what code.c++ estimates with\n",
+            spread.ohms, spread.heatMass, spread.heatLoss );
+    printf( "  %-10s %10s %10s %10s\n", "", "hottest", "hot for", "torque" );
+    const char *names[2] = { "plain", "code.c++" };
+    for( int32_t k = 0; k < 2; k++ ) {
+      const claw &c = _claws[k];
+      printf( "  %-10s %8.1f C %8.1f S %7.3f Nm\n", names[k], c.hottest, c.hotTime,
+              c.pushTime > 0 ? c.torque / c.pushTime : 0.0 );
+    }
+
+    char detail[64];
+    const claw &plain = _claws[0], &derated = _claws[1];
+    snprintf( detail, sizeof(detail), "%.3f C worst", _error );
+    bench::check( "estimate against the model", _error < BENCH_ERROR, detail );
+
+    snprintf( detail, sizeof(detail), "predicted %.1fS, hot at %.1fS", _predicted, plain.firstHot );
+    bench::check( "time to overtemp", plain.hotTime > 0 &&
+           fabs( _predicted - plain.firstHot ) <= plain.firstHot * BENCH_PREDICT / 100.0, detail );
+
+    snprintf( detail, sizeof(detail), "%.1fS hot, %.1fS", plain.hotTime, derated.hotTime );
+    bench::check( "only the plain claw overheats", plain.hotTime > 0 && derated.hotTime == 0, detail );
+    return( bench::result() );
+}
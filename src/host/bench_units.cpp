@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       bench_units.cpp
+//    Description:  Typed unit calls against the unit enum calls
+//
+//----------------------------------------------------------------------------
+
+// Two things, on a geared motor that is turning
+//
+//   check    - random positions and speeds are set and read back both ways,
+//              and random moves are commanded both ways, and what the
+//              typed calls report or send is compared with what the enum
+//              calls do
+//   time     - how long position, velocity and setPosition take a call
+//              with the enum and with the typed unit
+//
+// The typed calls convert and call the enum ones, so they are meant to come
+// out the same to within rounding of an encoder count and to cost the same
+// give or take the multiply.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+#include "vex_sim.h"
+#include "bench.h"
+
+using namespace vex;
+
+#define BENCH_PORT            3       // PORT4
+#define BENCH_GEAR            3.0     // output turns once for 3 motor turns
+#define BENCH_CHECKS          10000
+#define BENCH_CALLS           10000000
+
+static motor              _arm( PORT4, BENCH_GEAR, true );
+
+static volatile double    _sink;
+
+/*----------------------------------------------------------------------------*/
+/*  Checks                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void
+check( const char *name, double worst, double limit, const char *units ) {
+    bench::checkf( worst <= limit, "  %-32s %10.6f   %-6s", name, worst, units );
+}
+
+static void
+checks() {
+    const double count = 360.0 / SIM_MOTOR_COUNTS / BENCH_GEAR;   // deg at the output
+    double pos = 0, rev = 0, rpm = 0, dps = 0, target = 0, command = 0;
+
+    for( int32_t k = 0; k < BENCH_CHECKS; k++ ) {
+      double deg = bench::between( -3600, 3600 );
+
+      _arm.setPosition( deg, degrees );
+      double a = _arm.position( degrees );
+      _arm.setPosition( degrees_t( deg ) );
+      pos = fmax( pos, fabs( _arm.position<degrees_t>().value() - a ) );
+      rev = fmax( rev, fabs( _arm.position<revolutions_t>().value() - _arm.position( rotationUnits::rev ) ) );
+
+      rpm = fmax( rpm, fabs( _arm.velocity<rpm_t>().value() - _arm.velocity( velocityUnits::rpm ) ) );
+      dps = fmax( dps, fabs( _arm.velocity<dps_t>().value() - _arm.velocity( velocityUnits::dps ) ) );
+
+      // the moves are compared on what goes to the motor
+      double speed = bench::between( -SIM_MOTOR_MAX_RPM, SIM_MOTOR_MAX_RPM ) / BENCH_GEAR;
+      _arm.spinTo( deg, degrees, speed, velocityUnits::rpm, false );
+      sim::motorState e = sim::portGet( BENCH_PORT )->motor;
+      _arm.spinTo( degrees_t( deg ), rpm_t( speed ), false );
+      sim::motorState t = sim::portGet( BENCH_PORT )->motor;
+      target  = fmax( target, fabs( t.target - e.target ) );
+      command = fmax( command, fabs( t.command - e.command ) );
+    }
+
+    printf( "units, worst difference over %d random values\n", BENCH_CHECKS );
+    check( "position in degrees", pos, count, "deg" );
+    check( "position in revolutions", rev, count / 360, "rev" );
+    check( "velocity in rpm", rpm, 1e-9, "rpm" );
+    check( "velocity in dps", dps, 1e-9, "dps" );
+    check( "spinTo target", target, 1, "counts" );
+    check( "spinTo velocity", command, 1, "pct" );
+
+    // what the compiler does with the units, worked out before the program runs
+    static_assert( revolutions_t( 720_deg ).value() == 2, "degrees to revolutions" );
+    static_assert( dps_t( 10_rpm ).value() == 60, "rpm to dps" );
+    static_assert( mm_t( 2_in ).value() == 50.8, "inches to mm" );
+    static_assert( !std::is_convertible<degrees_t, mm_t>::value, "degrees to mm" );
+    static_assert( !std::is_convertible<double, degrees_t>::value, "a plain number to degrees" );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Timing                                                                    */
+/*----------------------------------------------------------------------------*/
+
+static void
+timing() {
+    printf( "units, %d calls each\n", BENCH_CALLS );
+    bench::timeCalls( "position( degrees )", BENCH_CALLS, [] { _sink = _arm.position( degrees ); } );
+    bench::timeCalls( "position<degrees_t>()", BENCH_CALLS, [] { _sink = _arm.position<degrees_t>().value(); } );
+    bench::timeCalls( "velocity( dps )", BENCH_CALLS, [] { _sink = _arm.velocity( velocityUnits::dps ); } );
+    bench::timeCalls( "velocity<dps_t>()", BENCH_CALLS, [] { _sink = _arm.velocity<dps_t>().value(); } );
+    bench::timeCalls( "setPosition( 90, degrees )", BENCH_CALLS, [] { _arm.setPosition( 90, degrees ); } );
+    bench::timeCalls( "setPosition( 90_deg )", BENCH_CALLS, [] { _arm.setPosition( 90_deg ); } );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The robot program                                                         */
+/*----------------------------------------------------------------------------*/
+
+static int
+benchMain() {
+    // turning, so there is a position and a speed to read
+    _arm.spin( forward, 40, percent );
+    task::sleep( 500 );
+
+    checks();
+    timing();
+    return( 0 );
+}
+
+int main( int argc, char **argv ) {
+    if( argc > 1 )
+      bench::usage( argv[0], "" );
+
+    srand( 1 );
+    sim::start( benchMain );
+    sim::runFor( 1000 );
+    return( bench::result() );
+}
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       logdecode.cpp
+//    Description:  Formats a log saved with baller --log-file, or telemetry as CSV
+//
+//----------------------------------------------------------------------------
+
+// The file is SIM_LOG_MAGIC then a stream of 8 byte words, either a record
+// exactly as it was in the ring (see vex_sim.h) or an entry starting with
+// a zero word
+//
+//   0, id, length, text     - the format string at address id
+//   0, 0, dropped           - end of the log, messages lost to a full ring
+//
+// Terminal messages go to stdout and console ones to stderr, as they would
+// have when the run formatted them itself.
+//
+// A file starting SIM_TELEMETRY_MAGIC is telemetry saved as binary, see
+// vex_sim.h, and is printed as the CSV telemetry::save would have written.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+static FILE *_in;
+
+static bool
+word( uint64_t &w ) {
+    return( fread( &w, sizeof(w), 1, _in ) == 1 );
+}
+
+// telemetry, after the magic
+static int
+telemetryDecode( const char *path ) {
+    uint32_t header[2];
+    if( fread( header, sizeof(header), 1, _in ) != 1 ) {
+      fprintf( stderr, "%s ends early, no sample count\n", path );
+      return( 1 );
+    }
+
+    uint8_t           rec[SIM_TELEMETRY_RECORD];
+    telemetry::sample s;
+    uint32_t          n = 0;
+    fputs( SIM_TELEMETRY_HEADER, stdout );
+    for( ; n < header[0] && fread( rec, sizeof(rec), 1, _in ) == 1; n++ ) {
+      sim::telemetryUnpack( rec, s );
+      sim::telemetryRow( stdout, s );
+    }
+    fclose( _in );
+
+    if( n < header[0] ) {
+      fprintf( stderr, "%s ends early, after %u of %u samples\n", path, n, header[0] );
+      return( 1 );
+    }
+    if( header[1] )
+      fprintf( stderr, "%u samples, %u lost before these\n", n, header[1] );
+    return( 0 );
+}
+
+static void
+usage( const char *name ) {
+    fprintf( stderr, "usage: %s [-t] logfile\n"
+                     "       %s telemetryfile\n", name, name );
+    exit( 1 );
+}
+
+int main( int argc, char **argv ) {
+    const char *path  = NULL;
+    bool        times = false;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( strcmp( argv[i], "-t" ) == 0 )
+        times = true;
+      else
+      if( path == NULL )
+        path = argv[i];
+      else
+        usage( argv[0] );
+    }
+    if( path == NULL )
+      usage( argv[0] );
+
+    _in = fopen( path, "rb" );
+    char magic[sizeof(SIM_LOG_MAGIC)] = "";
+    static_assert( sizeof(SIM_LOG_MAGIC) == sizeof(SIM_TELEMETRY_MAGIC), "magics are the same length" );
+    if( _in != NULL && fread( magic, 1, strlen( SIM_LOG_MAGIC ), _in ) == strlen( SIM_LOG_MAGIC ) &&
+        strcmp( magic, SIM_TELEMETRY_MAGIC ) == 0 )
+      return( telemetryDecode( path ) );
+    if( _in == NULL || strcmp( magic, SIM_LOG_MAGIC ) != 0 ) {
+      fprintf( stderr, "%s is not a log file\n", path );
+      return( 1 );
+    }
+
+    std::map<uint64_t, std::string> formats;
+    uint64_t rec[0x10000];
+    char     text[256];
+    uint32_t messages = 0;
+    bool     ended    = false;
+
+    while( word( rec[0] ) ) {
+      if( rec[0] == 0 ) {
+        uint64_t id, n;
+        if( !word( id ) || !word( n ) )
+          break;
+        if( id == 0 ) {
+          printf( "%u messages, %u dropped\n", messages, (uint32_t)n );
+          ended = true;
+          break;
+        }
+        std::string &s = formats[id];
+        s.clear();
+        for( uint64_t j = 0; j < (n + 8) / 8; j++ ) {
+          uint64_t w;
+          if( !word( w ) )
+            break;
+          s.append( (const char *)&w, 8 );
+        }
+        s.resize( n );
+        continue;
+      }
+
+      uint32_t n = SIM_LOG_LENGTH( rec[0] );
+      if( n < 3 || fread( rec + 1, sizeof(uint64_t), n - 1, _in ) != n - 1 )
+        break;
+      auto f = formats.find( rec[1] );
+      if( f == formats.end() ) {
+        fprintf( stderr, "record at %.6fS has no format\n", rec[2] / 1e6 );
+        continue;
+      }
+      sim::logRender( rec, f->second.c_str(), text, sizeof(text) );
+      FILE *out = (SIM_LOG_SINK( rec[0] ) == (uint32_t)logger::sink::console) ? stderr : stdout;
+      if( times )
+        fprintf( out, "%12.6f  ", rec[2] / 1e6 );
+      fputs( text, out );
+      messages++;
+    }
+
+    if( !ended )
+      fprintf( stderr, "%s ends early, after %u messages\n", path, messages );
+    fclose( _in );
+    return( ended ? 0 : 1 );
+}
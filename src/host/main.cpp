@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       main.cpp
+//    Description:  Entry point for running a robot program on Linux
+//
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#include "vex_sim.h"
+
+// main from code.c++, renamed when the Makefile builds robot.o
+extern "C" int vexUserMain( void );
+
+// the claw as code.c++ configures it, recorded for --telemetry-file so the
+// robot program does not need the host's telemetry
+extern vex::motor claw;
+
+// --coalesce sonar3=latest, axisD=interval:50, sonar3:autoGrab=hysteresis:20
+// the callback is looked up by name so it has to be a global function
+static bool
+coalesce( const char *spec ) {
+    char    event[32], callback[64] = "", policy[16] = "";
+    int32_t value = 0;
+
+    if( sscanf( spec, "%31[^:=]:%63[^=]=%15[^:]:%d", event, callback, policy, &value ) < 3 &&
+        sscanf( spec, "%31[^:=]=%15[^:]:%d", event, policy, &value ) < 2 )
+      return( false );
+
+    // a port's rule covers all its events, an axis's only that axis's
+    // changed event and not the controller's buttons or other axes
+    int32_t  index = -1;
+    uint32_t mask  = ~0u;
+    int32_t  port;
+    char     axis;
+    if( sscanf( event, "sonar%d", &port ) == 1 || sscanf( event, "port%d", &port ) == 1 )
+      index = port - 1;
+    else
+    if( sscanf( event, "axis%c", &axis ) == 1 && axis >= 'A' && axis <= 'D' ) {
+      index = SIM_INDEX_CONTROLLER;
+      mask  = 1u << (16 + axis - 'A');
+    }
+    if( index < 0 )
+      return( false );
+
+    vex::sim::coalescePolicy p = { vex::sim::coalesceType::none, value };
+    if( strcmp( policy, "latest" ) == 0 )
+      p.type = vex::sim::coalesceType::latest;
+    else
+    if( strcmp( policy, "interval" ) == 0 )
+      p.type = vex::sim::coalesceType::interval;
+    else
+    if( strcmp( policy, "hysteresis" ) == 0 )
+      p.type = vex::sim::coalesceType::hysteresis;
+    else
+    if( strcmp( policy, "none" ) != 0 )
+      return( false );
+
+    const void *fn = NULL;
+    if( callback[0] ) {
+      char mangled[80];
+      snprintf( mangled, sizeof(mangled), "_Z%zu%sv", strlen( callback ), callback );
+      fn = dlsym( RTLD_DEFAULT, mangled );
+      if( fn == NULL )
+        fn = dlsym( RTLD_DEFAULT, callback );
+      if( fn == NULL ) {
+        fprintf( stderr, "no callback called %s\n", callback );
+        return( false );
+      }
+    }
+    return( vex::sim::eventCoalesce( index, mask, fn, p ) );
+}
+
+static void
+usage( const char *name ) {
+    fprintf( stderr, "usage: %s [-d duration_ms] [-s script] [--realtime] [--screen] [--lcd-stats]\n"
+                     "       [--profile] [--profile-file path] [--coalesce event[:callback]=policy[:value]]\n"
+                     "       [--log-file path] [--telemetry-file path]\n", name );
+    exit( 1 );
+}
+
+int main( int argc, char **argv ) {
+    uint32_t    duration = SIM_MATCH_TIME;
+    bool        screen   = false;
+    bool        lcdStats = false;
+    bool        profile  = false;
+    const char *profPath = NULL;
+    FILE       *logFile  = NULL;
+    const char *tlmPath  = NULL;
+
+    for( int i = 1; i < argc; i++ ) {
+      if( (strcmp( argv[i], "-d" ) == 0 || strcmp( argv[i], "--duration" ) == 0) && i + 1 < argc )
+        duration = strtoul( argv[++i], NULL, 0 );
+      else
+      if( (strcmp( argv[i], "-s" ) == 0 || strcmp( argv[i], "--script" ) == 0) && i + 1 < argc ) {
+        if( !vex::sim::scriptLoad( argv[++i] ) )
+          return( 1 );
+      }
+      else
+      if( strcmp( argv[i], "--realtime" ) == 0 )
+        vex::sim::setRealtime( true );
+      else
+      if( strcmp( argv[i], "--screen" ) == 0 )
+        screen = true;
+      else
+      if( strcmp( argv[i], "--lcd-stats" ) == 0 )
+        lcdStats = true;
+      else
+      if( strcmp( argv[i], "--coalesce" ) == 0 && i + 1 < argc ) {
+        if( !coalesce( argv[++i] ) ) {
+          fprintf( stderr, "bad coalesce rule %s\n", argv[i] );
+          return( 1 );
+        }
+      }
+      else
+      if( strcmp( argv[i], "--profile" ) == 0 )
+        profile = true;
+      else
+      if( strcmp( argv[i], "--profile-file" ) == 0 && i + 1 < argc ) {
+        profile  = true;
+        profPath = argv[++i];
+      }
+      else
+      if( strcmp( argv[i], "--log-file" ) == 0 && i + 1 < argc ) {
+        logFile = fopen( argv[++i], "wb" );
+        if( logFile == NULL ) {
+          fprintf( stderr, "cannot write %s\n", argv[i] );
+          return( 1 );
+        }
+      }
+      else
+      if( strcmp( argv[i], "--telemetry-file" ) == 0 && i + 1 < argc )
+        tlmPath = argv[++i];
+      else
+        usage( argv[0] );
+    }
+
+    vex::sim::profileEnable( profile );
+    vex::sim::logFile( logFile );
+    vex::sim::start( vexUserMain );
+    if( tlmPath ) {
+      vex::telemetry::add( claw );
+      vex::telemetry::start( SIM_TELEMETRY_RATE );
+    }
+    vex::sim::runFor( duration );
+
+    // whatever the drain task has not got to yet
+    if( logFile ) {
+      vex::sim::logFile( NULL );
+      fclose( logFile );
+    }
+    else
+      vex::logger::drain();
+    if( vex::logger::dropped() )
+      fprintf( stderr, "log sent %u messages, dropped %u\n", vex::logger::sent(), vex::logger::dropped() );
+
+    // CSV if the name says so, otherwise binary for logdecode
+    if( tlmPath ) {
+      size_t len = strlen( tlmPath );
+      bool   csv = len > 4 && strcmp( tlmPath + len - 4, ".csv" ) == 0;
+      if( !vex::telemetry::save( tlmPath, csv ? vex::telemetry::fileType::csv : vex::telemetry::fileType::binary ) )
+        fprintf( stderr, "cannot write %s\n", tlmPath );
+    }
+
+    vex::sim::lcdPush();
+    if( screen )
+      vex::sim::lcdDump( stdout );
+    if( lcdStats ) {
+      const vex::sim::lcdStats &s = vex::sim::lcdStatsGet();
+      printf( "screen pushes %u, bytes %llu, last %u, %.1f%% of full redraws (%llu)\n",
+              s.frames, (unsigned long long)s.bytes, s.lastBytes,
+              s.fullBytes ? 100.0 * s.bytes / s.fullBytes : 0.0, (unsigned long long)s.fullBytes );
+    }
+
+    // stdout is where Brain.Terminal goes on the host
+    if( profile ) {
+      FILE *fp = profPath ? fopen( profPath, "w" ) : stdout;
+      if( fp == NULL ) {
+        fprintf( stderr, "cannot write %s\n", profPath );
+        return( 1 );
+      }
+      vex::sim::profileDump( fp );
+      if( fp != stdout )
+        fclose( fp );
+    }
+    return( 0 );
+}
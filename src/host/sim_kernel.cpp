@@ -0,0 +1,557 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       sim_kernel.cpp
+//    Description:  Cooperative host scheduler for the IQ runtime
+//
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include <chrono>
+
+#include "sim_kernel.h"
+
+namespace vex {
+  namespace sim {
+    enum class tState {
+      FREE = 0,
+      READY,
+      SLEEPING,
+      BLOCKED,
+      DONE
+    };
+
+    struct tcb {
+      ucontext_t    ctx;          // to start the task on its own stack
+      jmp_buf       jmp;          // where it gave up the cpu
+      bool          started;
+      void         *stack;
+      void        (* entry)(void *);
+      void         *arg;
+      const void   *tag;
+      const char   *name;
+      int32_t       priority;
+      tState        state;
+      bool          suspended;
+      bool          yielded;      // gave up the cpu without waiting for anything
+      usec_t        wake;         // sleep deadline, or block timeout when non zero
+      int32_t       waitSem;      // semaphore the task is blocked on, or -1
+      int16_t       id;
+    };
+
+    struct ksem {
+      bool          used;
+      tcb          *owner;
+    };
+
+    struct ktimer {
+      usec_t        time;
+      void        (* fn)(void *);
+      void         *arg;
+    };
+  };
+};
+
+using namespace vex::sim;
+
+// Task table, slots are reused once a task has finished
+static tcb          _tasks[SIM_TASK_MAX];
+static tcb         *_current = NULL;
+static int32_t      _rr = 0;
+static ucontext_t   _schedctx;
+static jmp_buf      _schedjmp;
+static int32_t      _slots = 0;   // task table slots ever used
+static bool         _stopped = false;
+
+// Clock
+static bool         _realtime = false;
+static usec_t       _clock    = 0;
+
+// Semaphore pool shared by semaphore and mutex
+static ksem         _sems[SIM_SEM_MAX];
+
+// Kernel timers, binary heap ordered on time
+static ktimer       _timers[SIM_TIMER_MAX];
+static int32_t      _ntimers = 0;
+
+/*----------------------------------------------------------------------------*/
+/*  Clock                                                                     */
+/*----------------------------------------------------------------------------*/
+
+usec_t
+vex::sim::now() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if( !_realtime )
+      return( _clock );
+    return( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+}
+
+void
+vex::sim::setRealtime( bool value ) {
+    _realtime = value;
+}
+
+bool
+vex::sim::realtime() {
+    return( _realtime );
+}
+
+static void
+idleUntil( usec_t time ) {
+    usec_t t = now();
+    if( time <= t )
+      return;
+
+    if( !_realtime ) {
+      _clock = time;
+      return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec  = (time - t) / 1000000;
+    ts.tv_nsec = ((time - t) % 1000000) * 1000;
+    nanosleep( &ts, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Kernel timers                                                             */
+/*----------------------------------------------------------------------------*/
+
+void
+vex::sim::callAt( usec_t time, void (* fn)(void *), void *arg ) {
+    if( _ntimers == SIM_TIMER_MAX ) {
+      fprintf( stderr, "sim: kernel timer table full, timer dropped\n" );
+      return;
+    }
+
+    // sift up
+    int32_t i = _ntimers++;
+    while( i > 0 ) {
+      int32_t p = (i - 1) / 2;
+      if( _timers[p].time <= time )
+        break;
+      _timers[i] = _timers[p];
+      i = p;
+    }
+    _timers[i].time = time;
+    _timers[i].fn   = fn;
+    _timers[i].arg  = arg;
+}
+
+static ktimer
+timerPop() {
+    ktimer top  = _timers[0];
+    ktimer last = _timers[--_ntimers];
+
+    // sift down
+    int32_t i = 0;
+    for(;;) {
+      int32_t c = 2 * i + 1;
+      if( c >= _ntimers )
+        break;
+      if( c + 1 < _ntimers && _timers[c+1].time < _timers[c].time )
+        c++;
+      if( last.time <= _timers[c].time )
+        break;
+      _timers[i] = _timers[c];
+      i = c;
+    }
+    if( _ntimers > 0 )
+      _timers[i] = last;
+
+    return( top );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Tasks                                                                     */
+/*----------------------------------------------------------------------------*/
+
+// A task is started once with swapcontext and after that every switch is
+// a _setjmp and _longjmp, swapcontext saves and restores the signal mask
+// with a system call each way and that was most of what a switch cost
+
+static void
+toScheduler( tcb *t ) {
+    if( _setjmp( t->jmp ) == 0 )
+      _longjmp( _schedjmp, 1 );
+}
+
+// makecontext only passes int arguments, so the tcb pointer is split in two
+static void
+trampoline( uint32_t hi, uint32_t lo ) {
+    tcb *t = (tcb *)(((uintptr_t)hi << 32) | (uintptr_t)lo);
+    t->entry( t->arg );
+    t->state = tState::DONE;
+    _longjmp( _schedjmp, 1 );
+}
+
+static void
+release( tcb *t ) {
+    free( t->stack );
+    t->stack = NULL;
+    t->state = tState::FREE;
+}
+
+tcb *
+vex::sim::taskCreate( void (* entry)(void *), void *arg, int32_t priority, const void *tag, const char *name ) {
+    static int16_t nextId = 0;
+
+    tcb *t = NULL;
+    for( int32_t i = 0; i < SIM_TASK_MAX; i++ ) {
+      if( _tasks[i].state == tState::FREE ) {
+        t = &_tasks[i];
+        if( i >= _slots )
+          _slots = i + 1;
+        break;
+      }
+    }
+    if( t == NULL ) {
+      fprintf( stderr, "sim: task table full, %s not created\n", name ? name : "task" );
+      return( NULL );
+    }
+
+    t->stack     = malloc( SIM_TASK_STACK );
+    t->entry     = entry;
+    t->arg       = arg;
+    t->tag       = tag;
+    t->name      = name;
+    t->priority  = priority;
+    t->state     = tState::READY;
+    t->started   = false;
+    t->suspended = false;
+    t->yielded   = false;
+    t->wake      = 0;
+    t->waitSem   = -1;
+    t->id        = nextId++;
+
+    getcontext( &t->ctx );
+    t->ctx.uc_stack.ss_sp   = t->stack;
+    t->ctx.uc_stack.ss_size = SIM_TASK_STACK;
+    t->ctx.uc_link          = &_schedctx;
+    makecontext( &t->ctx, (void (*)(void))trampoline, 2, (uint32_t)((uintptr_t)t >> 32), (uint32_t)(uintptr_t)t );
+
+    return( t );
+}
+
+void
+vex::sim::taskDelete( tcb *t ) {
+    if( t == NULL || t->state == tState::FREE )
+      return;
+
+    if( t == _current ) {
+      t->state = tState::DONE;
+      toScheduler( t );
+      // not reached
+    }
+    release( t );
+}
+
+// every task that was created with a tag except the caller, i.e. user tasks
+void
+vex::sim::taskDeleteTagged() {
+    for( int32_t i = 0; i < SIM_TASK_MAX; i++ ) {
+      tcb *t = &_tasks[i];
+      if( t != _current && t->tag != NULL && taskAlive( t ) )
+        release( t );
+    }
+}
+
+tcb *
+vex::sim::taskCurrent() {
+    return( _current );
+}
+
+tcb *
+vex::sim::taskFind( const void *tag ) {
+    for( int32_t i = 0; i < SIM_TASK_MAX; i++ ) {
+      tcb *t = &_tasks[i];
+      if( t->state != tState::FREE && t->state != tState::DONE && t->tag == tag )
+        return( t );
+    }
+    return( NULL );
+}
+
+bool
+vex::sim::taskAlive( tcb *t ) {
+    return( t != NULL && t->state != tState::FREE && t->state != tState::DONE );
+}
+
+int16_t
+vex::sim::taskId( tcb *t ) {
+    return( t ? t->id : -1 );
+}
+
+int32_t
+vex::sim::taskPriority( tcb *t ) {
+    return( t ? t->priority : 0 );
+}
+
+void
+vex::sim::taskSetPriority( tcb *t, int32_t priority ) {
+    if( t )
+      t->priority = priority;
+}
+
+void
+vex::sim::taskSuspend( tcb *t ) {
+    if( t == NULL )
+      return;
+    t->suspended = true;
+    if( t == _current )
+      toScheduler( t );
+}
+
+void
+vex::sim::taskResume( tcb *t ) {
+    if( t )
+      t->suspended = false;
+}
+
+void
+vex::sim::taskDump() {
+    static const char *names[] = { "free", "ready", "sleeping", "blocked", "done" };
+
+    printf( "id  pri state     name\n" );
+    for( int32_t i = 0; i < SIM_TASK_MAX; i++ ) {
+      tcb *t = &_tasks[i];
+      if( t->state == tState::FREE )
+        continue;
+      printf( "%-3d %-3d %-9s %s%s\n", t->id, t->priority, names[(int)t->state],
+              t->name ? t->name : "", t->suspended ? " (suspended)" : "" );
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Blocking calls, these act on the current task                             */
+/*----------------------------------------------------------------------------*/
+
+void
+vex::sim::taskSleepUntil( usec_t time ) {
+    if( _current == NULL ) {
+      // called outside of a task, e.g. from a global constructor
+      idleUntil( time );
+      return;
+    }
+
+    tcb *t = _current;
+    t->state = tState::SLEEPING;
+    t->wake  = time;
+    toScheduler( t );
+}
+
+void
+vex::sim::taskSleep( usec_t time ) {
+    taskSleepUntil( now() + time );
+}
+
+void
+vex::sim::taskYield() {
+    if( _current == NULL )
+      return;
+    _current->yielded = true;
+    toScheduler( _current );
+}
+
+void
+vex::sim::taskBlock() {
+    if( _current == NULL )
+      return;
+
+    tcb *t = _current;
+    t->state = tState::BLOCKED;
+    t->wake  = 0;
+    toScheduler( t );
+}
+
+// block with a timeout, returns false if the timeout expired first
+bool
+vex::sim::taskBlockUntil( usec_t time ) {
+    if( _current == NULL )
+      return( false );
+
+    tcb *t = _current;
+    t->state = tState::BLOCKED;
+    t->wake  = time;
+    toScheduler( t );
+
+    bool woken = (t->wake != 0);
+    t->wake = 0;
+    return( woken );
+}
+
+void
+vex::sim::taskWake( tcb *t ) {
+    if( t && t->state == tState::BLOCKED )
+      t->state = tState::READY;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Semaphores                                                                */
+/*----------------------------------------------------------------------------*/
+
+int32_t
+vex::sim::semCreate() {
+    for( int32_t i = 0; i < SIM_SEM_MAX; i++ ) {
+      if( !_sems[i].used ) {
+        _sems[i].used  = true;
+        _sems[i].owner = NULL;
+        return( i );
+      }
+    }
+    fprintf( stderr, "sim: semaphore pool full\n" );
+    return( -1 );
+}
+
+void
+vex::sim::semDelete( int32_t sem ) {
+    if( sem >= 0 && sem < SIM_SEM_MAX )
+      _sems[sem].used = false;
+}
+
+bool
+vex::sim::semTryLock( int32_t sem ) {
+    if( sem < 0 || sem >= SIM_SEM_MAX )
+      return( false );
+    if( _sems[sem].owner != NULL )
+      return( false );
+    _sems[sem].owner = _current;
+    return( true );
+}
+
+bool
+vex::sim::semLock( int32_t sem, usec_t timeout ) {
+    usec_t deadline = timeout ? now() + timeout : 0;
+
+    while( !semTryLock( sem ) ) {
+      if( _current == NULL || sem < 0 || sem >= SIM_SEM_MAX )
+        return( false );
+
+      _current->waitSem = sem;
+      bool woken = deadline ? taskBlockUntil( deadline ) : (taskBlock(), true);
+      _current->waitSem = -1;
+      if( !woken )
+        return( false );
+    }
+    return( true );
+}
+
+void
+vex::sim::semUnlock( int32_t sem ) {
+    if( sem < 0 || sem >= SIM_SEM_MAX )
+      return;
+
+    _sems[sem].owner = NULL;
+    // waiters contend again when they run
+    for( int32_t i = 0; i < SIM_TASK_MAX; i++ ) {
+      if( _tasks[i].state == tState::BLOCKED && _tasks[i].waitSem == sem )
+        _tasks[i].state = tState::READY;
+    }
+}
+
+bool
+vex::sim::semOwner( int32_t sem ) {
+    if( sem < 0 || sem >= SIM_SEM_MAX )
+      return( false );
+    return( _sems[sem].owner != NULL && _sems[sem].owner == _current );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Scheduler                                                                 */
+/*----------------------------------------------------------------------------*/
+
+// highest priority ready task, round robin between equal priorities
+// with the virtual clock a task that yielded waits for the next tick, or a
+// polling loop that only yields would stop time
+static tcb *
+pick( bool *yielding ) {
+    tcb *best = NULL;
+    *yielding = false;
+    for( int32_t n = 1; n <= _slots; n++ ) {
+      int32_t i = (_rr + n) % _slots;
+      tcb *t = &_tasks[i];
+      if( t->state != tState::READY || t->suspended )
+        continue;
+      if( t->yielded && !_realtime ) {
+        *yielding = true;
+        continue;
+      }
+      if( best == NULL || t->priority > best->priority ) {
+        best = t;
+        _rr  = i;
+      }
+    }
+    return( best );
+}
+
+void
+vex::sim::run( usec_t until ) {
+    _stopped = false;
+
+    while( !_stopped ) {
+      usec_t t = now();
+      if( t >= until )
+        break;
+
+      // kernel timers that are due
+      while( _ntimers > 0 && _timers[0].time <= t ) {
+        ktimer k = timerPop();
+        k.fn( k.arg );
+      }
+
+      // sleeping tasks and block timeouts that are due, and the earliest one that is not
+      usec_t next = until;
+      for( int32_t i = 0; i < _slots; i++ ) {
+        tcb *s = &_tasks[i];
+        if( s->state != tState::SLEEPING && !(s->state == tState::BLOCKED && s->wake) )
+          continue;
+        if( s->wake <= t ) {
+          if( s->state == tState::BLOCKED )
+            s->wake = 0;  // timed out
+          s->state = tState::READY;
+        }
+        else
+        if( s->wake < next )
+          next = s->wake;
+      }
+
+      bool yielding;
+      tcb *r = pick( &yielding );
+      if( r != NULL ) {
+        r->yielded = false;
+        _current = r;
+        if( _setjmp( _schedjmp ) == 0 ) {
+          if( r->started )
+            _longjmp( r->jmp, 1 );
+          r->started = true;
+          swapcontext( &_schedctx, &r->ctx );
+        }
+        _current = NULL;
+        if( r->state == tState::DONE )
+          release( r );
+        continue;
+      }
+
+      // nothing to run
+      if( _ntimers > 0 && _timers[0].time < next )
+        next = _timers[0].time;
+
+      // only tasks that yielded, move on one tick and let them run again
+      if( yielding ) {
+        for( int32_t i = 0; i < _slots; i++ )
+          _tasks[i].yielded = false;
+        if( t + SIM_TICK < next )
+          next = t + SIM_TICK;
+      }
+      idleUntil( next );
+    }
+}
+
+void
+vex::sim::stop() {
+    _stopped = true;
+}
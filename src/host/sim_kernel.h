@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       sim_kernel.h
+//    Description:  Host scheduler and clock behind the iq_cpp.h task API
+//
+//----------------------------------------------------------------------------
+
+#ifndef   SIM_KERNEL_H
+#define   SIM_KERNEL_H
+
+#include <stdint.h>
+
+// The IQ brain runs every task and event handler cooperatively on one core.
+// We do the same on the host: each task gets its own stack (ucontext) and
+// only gives up the cpu in sleep, yield or a blocking call, so a run is
+// deterministic for a given input script.
+
+namespace vex {
+  namespace sim {
+    typedef uint64_t  usec_t;
+
+    #define SIM_TASK_MAX        128         // tasks alive at once
+    #define SIM_TASK_STACK      (128*1024)  // bytes of stack per task
+    #define SIM_TIMER_MAX       256         // pending kernel timers
+    #define SIM_SEM_MAX         64          // semaphores and mutexes
+    #define SIM_TICK            1000        // uS, clock step when tasks only yield
+
+    struct tcb;
+
+    //
+    // Clock, microseconds since the kernel started
+    // The clock is virtual unless realtime is set, it only moves when every
+    // task is waiting and then jumps straight to the next wakeup, so a run
+    // takes as long as the code in it rather than the time it simulates.
+    //
+    usec_t    now( void );
+    void      setRealtime( bool value );
+    bool      realtime( void );
+
+    //
+    // Tasks
+    // tag is used to find a task again from the user callback (task::stop etc.)
+    //
+    tcb      *taskCreate( void (* entry)(void *), void *arg, int32_t priority, const void *tag, const char *name );
+    void      taskDelete( tcb *t );
+    void      taskDeleteTagged( void );
+    tcb      *taskCurrent( void );
+    tcb      *taskFind( const void *tag );
+    bool      taskAlive( tcb *t );
+    int16_t   taskId( tcb *t );
+    int32_t   taskPriority( tcb *t );
+    void      taskSetPriority( tcb *t, int32_t priority );
+    void      taskSuspend( tcb *t );
+    void      taskResume( tcb *t );
+    void      taskDump( void );
+
+    // these act on the current task
+    void      taskSleepUntil( usec_t time );
+    void      taskSleep( usec_t time );
+    void      taskYield( void );
+    void      taskBlock( void );
+    bool      taskBlockUntil( usec_t time );
+    void      taskWake( tcb *t );
+
+    //
+    // Semaphores, owned by the task that locked them
+    // timeout of 0 waits forever
+    //
+    int32_t   semCreate( void );
+    void      semDelete( int32_t sem );
+    bool      semLock( int32_t sem, usec_t timeout );
+    bool      semTryLock( int32_t sem );
+    void      semUnlock( int32_t sem );
+    bool      semOwner( int32_t sem );
+
+    //
+    // Kernel timers, fn is called from the scheduler and must not block
+    //
+    void      callAt( usec_t time, void (* fn)(void *), void *arg );
+
+    //
+    // Run the scheduler until the clock reaches until or stop() is called
+    //
+    void      run( usec_t until );
+    void      stop( void );
+  };
+};
+
+#endif // SIM_KERNEL_H
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       sim_motor.cpp
+//    Description:  DC motor model behind the simulated IQ smart motor
+//
+//----------------------------------------------------------------------------
+
+// Everything is seen from the output shaft. The back emf constant comes
+// from the free speed at SIM_MOTOR_VOLTS and the torque constant from the
+// stall torque at the current limit, the gap between them is what the
+// gearbox loses. Winding inductance is left out, its time constant is far
+// shorter than a model step. A port's motorSpread moves its winding
+// resistance and thermal constants off the model's, as one motor out of a
+// box is never quite the one on the data sheet.
+//
+// The firmware side is a current loop under a velocity loop under, in
+// position and hold mode, the same position law the motor always had. It
+// only knows the motor's own inertia, so a heavy load slows the response
+// down as it would on the robot, and it limits the winding current to the
+// max torque setting, to half that while the motor is hot.
+//
+// Each step is a few dozen flops, a motor costs SIM_MOTOR_STEPS of them a
+// poll, so the model itself is not what sets how fast a run goes.
+
+#include <math.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+#define RPM             (2 * M_PI / 60.0)                                   // rad/S per rpm
+#define COUNT           (2 * M_PI / SIM_MOTOR_COUNTS)                       // rad per count
+#define KE              (SIM_MOTOR_VOLTS / (SIM_MOTOR_MAX_RPM * RPM))       // V per rad/S
+#define KT              (SIM_MOTOR_STALL_NM / SIM_MOTOR_MAX_AMPS)           // Nm per A
+
+#define LOOP_TAU        0.03    // S, velocity loop response on an unloaded motor
+#define LOOP_INTEGRAL   0.1     // S, for the loop to take up a steady load
+#define LOOP_GAIN       (SIM_MOTOR_INERTIA / (KT * LOOP_TAU))               // A per rad/S
+
+static inline double
+sign( double x ) {
+    return( (x > 0) - (x < 0) );
+}
+
+static inline double
+clamp( double x, double limit ) {
+    return( x > limit ? limit : (x < -limit ? -limit : x) );
+}
+
+// rad/S the velocity loop is after, for the modes that use it
+static inline double
+wanted( const sim::motorState &c, double position ) {
+    double rpm;
+    switch( c.mode ) {
+      case sim::motorMode::velocity:
+        rpm = c.command * SIM_MOTOR_MAX_RPM / 100.0;
+        break;
+      case sim::motorMode::hold:
+        rpm = clamp( (c.target - position) * 0.625, SIM_MOTOR_MAX_RPM );
+        break;
+      default:
+        // rpm that would close the error in 100mS, limited to the commanded speed
+        rpm = clamp( (c.target - position) * 0.625, fabs( c.command ) * SIM_MOTOR_MAX_RPM / 100.0 );
+        break;
+    }
+    return( rpm * RPM );
+}
+
+void
+sim::motorModel( port &p, const motorState &c, double volts, double dt ) {
+    motorState        &m = p.motor;
+    const motorLoad   &l = p.load;
+    const motorSpread &s = p.spread;
+
+    int32_t n = (int32_t)ceil( dt * 1000.0 * SIM_MOTOR_STEPS / SIM_POLL_INTERVAL - 1e-9 );
+    if( n <= 0 )
+      return;
+
+    const double h       = dt / n;
+    const double inertia = SIM_MOTOR_INERTIA + l.inertia;
+    const double drag    = SIM_MOTOR_FRICTION + l.friction;
+    const bool   loop    = c.mode == motorMode::velocity || c.mode == motorMode::position || c.mode == motorMode::hold;
+    double       limit   = SIM_MOTOR_MAX_AMPS * c.maxTorque / 100.0;
+    if( m.flags & VEXIQ_MOTOR_OVERTEMP_FLAG )
+      limit *= SIM_MOTOR_HOT_LIMIT / 100.0;
+
+    // per step factors, divides are the slow part of a step
+    const double accel   = h / inertia;
+    const double travel  = h / 2 / COUNT;
+    const double ohms    = SIM_MOTOR_OHMS * (1 + s.ohms / 100.0);
+    const double heat    = h / (SIM_MOTOR_HEAT_MASS * (1 + s.heatMass / 100.0));
+    const double soak    = LOOP_GAIN * h / LOOP_INTEGRAL;
+    const double mho     = 1 / ohms;
+    const double cool    = 1 / (SIM_MOTOR_HEAT_LOSS * (1 + s.heatLoss / 100.0));
+
+    // as far as the compiler knows c could be m, so work on locals
+    // and store them at the end
+    double w       = m.velocity * RPM;
+    double x       = m.position;
+    double sum     = m.integral;
+    double temp    = m.temperature;
+    double amps    = 0;
+    double v       = 0;
+    bool   limited = false;
+
+    for( int32_t k = 0; k < n; k++ ) {
+      // what the firmware puts across the windings
+      double i;
+      if( c.mode == motorMode::coast ) {
+        v = KE * w;
+        i = 0;
+      }
+      else {
+        if( loop ) {
+          double err = wanted( c, x ) - w;
+          v   = KE * w + (LOOP_GAIN * err + sum) * ohms;
+          sum = clamp( sum + soak * err, limit );
+        }
+        else
+          v = (c.mode == motorMode::voltage) ? c.command : 0;
+
+        v = clamp( v, volts );
+        i = (v - KE * w) * mho;
+
+        // shorting the windings to brake is not limited
+        limited = c.mode != motorMode::brake && fabs( i ) > limit;
+        if( limited ) {
+          i = sign( i ) * limit;
+          v = KE * w + i * ohms;
+        }
+      }
+
+      // drag holds a stopped motor until the drive gets past it, and only
+      // ever slows a moving one down to a stop
+      double drive = KT * i - l.torque;
+      double w0    = w;
+      if( w != 0 || fabs( drive ) > drag ) {
+        double against = (w != 0) ? sign( w ) : sign( drive );
+        w += (drive - drag * against) * accel;
+        if( w0 != 0 && sign( w ) != sign( w0 ) && fabs( drive ) <= drag )
+          w = 0;
+      }
+      x += (w0 + w) * travel;
+
+      if( l.stops ) {
+        if( x <= l.low && w <= 0 ) {
+          x = l.low;
+          w = 0;
+        }
+        else
+        if( x >= l.high && w >= 0 ) {
+          x = l.high;
+          w = 0;
+        }
+      }
+
+      temp += (i * i * ohms - (temp - SIM_MOTOR_AMBIENT) * cool) * heat;
+      amps += fabs( i );
+    }
+
+    m.position    = x;
+    m.velocity    = w / RPM;
+    m.current     = amps / n;
+    m.voltage     = v;
+    m.temperature = temp;
+    m.integral    = sum;
+
+    if( limited )
+      m.flags |= VEXIQ_MOTOR_CURLIMIT_FLAG;
+    else
+      m.flags &= ~VEXIQ_MOTOR_CURLIMIT_FLAG;
+
+    if( fabs( m.velocity ) < 1.0 )
+      m.flags |= VEXIQ_MOTOR_ZEROVEL_FLAG;
+    else
+      m.flags &= ~VEXIQ_MOTOR_ZEROVEL_FLAG;
+
+    if( c.mode == motorMode::position && fabs( c.target - x ) < 5 )
+      m.flags |= VEXIQ_MOTOR_ZEROPOS_FLAG;
+    else
+      m.flags &= ~VEXIQ_MOTOR_ZEROPOS_FLAG;
+
+    if( m.temperature >= SIM_MOTOR_HOT )
+      m.flags |= VEXIQ_MOTOR_OVERTEMP_FLAG;
+    else
+    if( m.temperature < SIM_MOTOR_COOLED )
+      m.flags &= ~VEXIQ_MOTOR_OVERTEMP_FLAG;
+}
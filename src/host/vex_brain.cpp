@@ -0,0 +1,103 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_brain.cpp
+//    Description:  Host implementation of vex::brain
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+int32_t brain::_index = SIM_INDEX_BRAIN;
+
+brain::brain() {
+}
+
+brain::~brain() {
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Buttons                                                                   */
+/*----------------------------------------------------------------------------*/
+
+void
+brain::button::pressed( void (* callback)(void) ) {
+    if( _id > 2 )
+      return;
+    event::init( _index, (uint32_t)tEventType::EVENT_UP_PRESSED << (2 * _id), callback );
+}
+
+void
+brain::button::released( void (* callback)(void) ) {
+    if( _id > 2 )
+      return;
+    event::init( _index, (uint32_t)tEventType::EVENT_UP_RELEASED << (2 * _id), callback );
+}
+
+bool
+brain::button::pressing() {
+    if( _id > 2 )
+      return( false );
+    return( (sim::frameGet().brain.buttons & (1 << _id)) != 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Timer                                                                     */
+/*----------------------------------------------------------------------------*/
+
+double
+brain::timer( timeUnits units ) {
+    return( Timer.time( units ) );
+}
+
+void
+brain::resetTimer() {
+    Timer.reset();
+}
+
+void
+brain::setTimer( double value, timeUnits units ) {
+    if( units == timeUnits::sec )
+      value *= 1000;
+    Timer = (uint32_t)value;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Battery                                                                   */
+/*----------------------------------------------------------------------------*/
+
+uint16_t
+brain::battery::capacity( percentUnits units ) {
+    return( sim::frameGet().brain.battery );
+}
+
+double
+brain::battery::voltage( voltageUnits units ) {
+    double v = sim::frameGet().brain.voltage;
+    return( units == voltageUnits::mV ? v * 1000 : v );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Sound, there is no speaker on the host so just note it on the terminal    */
+/*----------------------------------------------------------------------------*/
+
+void
+brain::playSound( soundType sound ) {
+    printf( "[sound %d]\n", (int)sound );
+}
+
+void
+brain::playNote( int32_t octave, int32_t note ) {
+    printf( "[note %d.%d]\n", octave, note );
+}
+
+void
+brain::playNote( int32_t octave, int32_t note, int32_t ms ) {
+    playNote( octave, note );
+    task::sleep( ms );
+}
+
+void
+brain::soundOff() {
+}
@@ -0,0 +1,17 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_console.cpp
+//    Description:  Host implementation of vex::console, the logger sends
+//                  console::write to stderr
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+console::console() {
+}
+
+console::~console() {
+}
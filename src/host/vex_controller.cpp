@@ -0,0 +1,76 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_controller.cpp
+//    Description:  Host implementation of vex::controller
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+controller::controller() : _index( SIM_INDEX_CONTROLLER ) {
+}
+
+controller::~controller() {
+}
+
+int32_t
+controller::_getIndex() {
+    return( _index );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Buttons, pressed and released are adjacent bits in the event mask         */
+/*----------------------------------------------------------------------------*/
+
+static uint32_t
+buttonEvent( int32_t id, bool released ) {
+    // ButtonL3 and ButtonR3 (IQ2) sit above the axis events
+    int32_t bit = (id < 8) ? (2 * id) : (20 + 2 * (id - 8));
+    return( 1 << (bit + (released ? 1 : 0)) );
+}
+
+void
+controller::button::pressed( void (* callback)(void) ) const {
+    if( _parent == NULL || _id == tButtonType::kButtonUndefined )
+      return;
+    event::init( _parent->_getIndex(), buttonEvent( (int32_t)_id, false ), callback );
+}
+
+void
+controller::button::released( void (* callback)(void) ) const {
+    if( _parent == NULL || _id == tButtonType::kButtonUndefined )
+      return;
+    event::init( _parent->_getIndex(), buttonEvent( (int32_t)_id, true ), callback );
+}
+
+bool
+controller::button::pressing() const {
+    if( _id == tButtonType::kButtonUndefined )
+      return( false );
+    return( (sim::frameGet().controller.buttons & (1 << (int32_t)_id)) != 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Axis                                                                      */
+/*----------------------------------------------------------------------------*/
+
+void
+controller::axis::changed( void (* callback)(void) ) const {
+    if( _parent == NULL || _id == tAxisType::kAxisUndefined )
+      return;
+    event::init( _parent->_getIndex(), 1 << ((int32_t)tEventType::EVENT_A_CHANGED + (int32_t)_id), callback );
+}
+
+int32_t
+controller::axis::value() const {
+    if( _id == tAxisType::kAxisUndefined )
+      return( 0 );
+    return( sim::frameGet().controller.axis[(int32_t)_id] );
+}
+
+int32_t
+controller::axis::position( percentUnits units ) const {
+    return( (value() * 100) / 127 );
+}
@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_device.cpp
+//    Description:  Host implementation of vex::device and vex::devices
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+/*----------------------------------------------------------------------------*/
+/*  device                                                                    */
+/*----------------------------------------------------------------------------*/
+
+device::device() : _lastpolltime( 0 ), _pollinterval( 0 ), _index( -1 ) {
+}
+
+device::device( int32_t index ) : _lastpolltime( 0 ), _pollinterval( 0 ), _index( index ) {
+}
+
+device::~device() {
+}
+
+void
+device::setPollInterval( int32_t value ) {
+    _pollinterval = value;
+}
+
+// true while the last value read from the port is still fresh enough to use
+// if not, and bSave is set, the caller is about to read so restart the interval
+bool
+device::pollValid( bool bSave ) {
+    int32_t t = timer::system();
+    if( _lastpolltime != 0 && (t - _lastpolltime) < _pollinterval )
+      return( true );
+    if( bSave )
+      _lastpolltime = t ? t : 1;
+    return( false );
+}
+
+IQ_DeviceType
+device::type() {
+    sim::port *p = sim::portGet( _index );
+    return( p ? p->type : kDeviceTypeNoSensor );
+}
+
+int32_t
+device::index() {
+    return( _index );
+}
+
+void
+device::init( int32_t index ) {
+    _index = index;
+}
+
+bool
+device::installed() {
+    return( type() != kDeviceTypeNoSensor );
+}
+
+int32_t
+device::value() {
+    return( 0 );
+}
+
+int32_t
+device::readDigitalPin() {
+    return( 0 );
+}
+
+int32_t
+device::readAnalogPin() {
+    return( 0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  devices                                                                   */
+/*----------------------------------------------------------------------------*/
+
+devices::devices() {
+}
+
+devices::~devices() {
+}
+
+IQ_DeviceType
+devices::type( int32_t index ) {
+    sim::port *p = sim::portGet( index );
+    return( p ? p->type : kDeviceTypeNoSensor );
+}
+
+int32_t
+devices::number() {
+    int32_t n = 0;
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ )
+      if( type( i ) != kDeviceTypeNoSensor )
+        n++;
+    return( n );
+}
+
+int32_t
+devices::numberOf( IQ_DeviceType type ) {
+    int32_t n = 0;
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ )
+      if( this->type( i ) == type )
+        n++;
+    return( n );
+}
@@ -0,0 +1,588 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_event.cpp
+//    Description:  Host implementation of vex::event
+//
+//----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+#include <algorithm>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+// Each registration gets its own handler task. A broadcast bumps the
+// pending count and wakes the task, which then runs the callback once per
+// pending trigger, so triggers that arrive while the callback is still
+// running queue up behind it the same way they do on the brain.
+//
+// Handlers come from a fixed pool and are found through a table with one
+// row per event index. A row gives each handler on the index a slot and
+// keeps, for every mask bit, a bitmap of the slots listening on it, so a
+// broadcast ORs one word per bit set in its mask and wakes what is left.
+// Nothing is allocated and nothing is walked that did not ask for the
+// event, the cost stays flat however many handlers other events have.
+//
+// broadcastAndWait notes, for every handler it woke, how many triggers
+// that handler must have finished for this broadcast to be done. Handlers
+// tick the waiter off as they return and the last one wakes it, there is
+// no polling.
+//
+// When profiling is on each trigger is stamped into a small ring indexed
+// by the handler's trigger count, the start of that trigger looks its
+// stamp up by the same count, which is still there unless more than
+// SIM_PROFILE_DEPTH triggers queued behind it.
+//
+// A handler with a coalescing policy folds triggers into the one already
+// pending rather than queueing another. The callbacks read their sensor
+// when they run, so folding loses nothing but stale readings.
+
+namespace {
+  struct handler {
+    int16_t     index;
+    uint32_t    mask;
+    void      (* callback)(void);
+    void      (* callbackArg)(void *);
+    void      (* callbackInt)(int);
+    void       *arg;
+    uint32_t    pending;
+    uint32_t    queued;                       // triggers ever received
+    uint32_t    done;                         // and finished
+    bool        running;
+    int16_t     slot;
+    sim::tcb   *task;
+
+    sim::coalescePolicy policy;
+    sim::usec_t lastStart;
+    int32_t     lastValue;
+    bool        haveValue;
+  };
+
+  struct alignas(64) row {
+    uint16_t    bits[32];                     // slots listening on each mask bit
+    handler    *slots[SIM_EVENT_SLOTS];       // in registration order
+    uint16_t    used;                         // slots taken
+  };
+
+  // one broadcastAndWait in progress, lives on the waiting task's stack
+  struct waiter {
+    int16_t         index;
+    uint16_t        outstanding;              // slots still to finish
+    uint32_t        target[SIM_EVENT_SLOTS];  // done count that completes each slot
+    sim::tcb       *task;
+    sim::eventWait  result;
+  };
+
+  struct profile {
+    uint32_t        first;                    // first trigger stamped
+    uint32_t        count;
+    uint32_t        unstamped;                // starts with no trigger time
+    uint32_t        merged;                   // triggers folded or dropped by coalescing
+    sim::usec_t     started;
+    sim::usec_t     runTotal;
+    sim::usec_t     runMax;
+    sim::usec_t     queueTotal;
+    sim::usec_t     queueMax;
+    uint32_t        runHist[SIM_PROFILE_BUCKETS];
+    uint32_t        queueHist[SIM_PROFILE_BUCKETS];
+    sim::usec_t     triggered[SIM_PROFILE_DEPTH];
+  };
+
+  struct coalesceRule {
+    int32_t             index;
+    uint32_t            mask;
+    const void         *callback;
+    sim::coalescePolicy policy;
+  };
+
+  static_assert( SIM_EVENT_SLOTS <= 16, "slot bitmaps are 16 bits" );
+}
+
+static row              _rows[SIM_INDEX_MAX];
+static handler          _pool[SIM_EVENT_MAX];
+static int32_t          _poolUsed = 0;
+
+static waiter          *_waiting[SIM_TASK_MAX];
+static int32_t          _waitingCount = 0;
+static sim::eventWait   _lastWait = { -1, 0, 0, -1, NULL, false, 0 };
+
+static bool             _profiling = false;
+static sim::usec_t      _profileStart = 0;
+static profile          _profile[SIM_EVENT_MAX];
+
+static coalesceRule     _rules[SIM_COALESCE_MAX];
+static int32_t          _ruleCount = 0;
+
+int16_t event::_usereventid = SIM_INDEX_USER;
+
+static const void *
+callbackOf( const handler *h ) {
+    if( h->callback )
+      return( (const void *)h->callback );
+    if( h->callbackArg )
+      return( (const void *)h->callbackArg );
+    return( (const void *)h->callbackInt );
+}
+
+// a rule covers a handler listening on its index for one of its bits
+static bool
+ruleMatches( const coalesceRule &r, const handler *h ) {
+    return( r.index == h->index && (r.mask & h->mask) &&
+            (r.callback == NULL || r.callback == callbackOf( h )) );
+}
+
+// tick h off every waiter that was waiting on it, wake those now complete
+static void
+finished( handler *h ) {
+    uint16_t bit = 1 << h->slot;
+
+    for( int32_t i = 0; i < _waitingCount; i++ ) {
+      waiter *w = _waiting[i];
+      if( w->index != h->index || !(w->outstanding & bit) || h->done < w->target[h->slot] )
+        continue;
+
+      w->outstanding &= ~bit;
+      w->result.finished++;
+      w->result.last         = h->slot;
+      w->result.lastCallback = callbackOf( h );
+      if( w->outstanding == 0 )
+        sim::taskWake( w->task );
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Profiling                                                                 */
+/*----------------------------------------------------------------------------*/
+
+static int32_t
+bucket( sim::usec_t t ) {
+    int32_t b = 0;
+    for( sim::usec_t limit = 1000; b < SIM_PROFILE_BUCKETS - 1 && t >= limit; limit <<= 1 )
+      b++;
+    return( b );
+}
+
+static void
+profileStart( handler *h ) {
+    profile &p   = _profile[h - _pool];
+    uint32_t seq = h->done;
+
+    p.started = sim::now();
+    if( seq < p.first || h->queued - seq > SIM_PROFILE_DEPTH ) {
+      p.unstamped++;
+      return;
+    }
+    sim::usec_t delay = p.started - p.triggered[seq % SIM_PROFILE_DEPTH];
+    p.queueTotal += delay;
+    if( delay > p.queueMax )
+      p.queueMax = delay;
+    p.queueHist[ bucket( delay ) ]++;
+}
+
+static void
+profileEnd( handler *h ) {
+    profile &p = _profile[h - _pool];
+
+    sim::usec_t run = sim::now() - p.started;
+    p.count++;
+    p.runTotal += run;
+    if( run > p.runMax )
+      p.runMax = run;
+    p.runHist[ bucket( run ) ]++;
+}
+
+void
+sim::profileEnable( bool on ) {
+    if( on && !_profiling ) {
+      memset( _profile, 0, sizeof(_profile) );
+      for( int32_t i = 0; i < _poolUsed; i++ )
+        _profile[i].first = _pool[i].queued;
+      _profileStart = now();
+    }
+    _profiling = on;
+}
+
+static void
+callbackName( const void *fn, char *buf, size_t len ) {
+    Dl_info info;
+    if( dladdr( fn, &info ) && info.dli_sname ) {
+      int   status;
+      char *name = abi::__cxa_demangle( info.dli_sname, NULL, NULL, &status );
+      snprintf( buf, len, "%s", status == 0 ? name : info.dli_sname );
+      free( name );
+    }
+    else
+      snprintf( buf, len, "%p", fn );
+}
+
+static void
+eventName( int32_t index, uint32_t mask, char *buf, size_t len ) {
+    if( index < IQ_MAX_DEVICE_PORTS )
+      snprintf( buf, len, "PORT%d/%x", index + 1, mask );
+    else
+    if( index == SIM_INDEX_BRAIN )
+      snprintf( buf, len, "brain/%x", mask );
+    else
+    if( index == SIM_INDEX_CONTROLLER )
+      snprintf( buf, len, "controller/%x", mask );
+    else
+      snprintf( buf, len, "user %d", index );
+}
+
+static void
+histDump( FILE *fp, const char *name, const uint32_t *hist ) {
+    static const char * const labels[SIM_PROFILE_BUCKETS] = {
+      "<1m", "<2m", "<4m", "<8m", "<16m", "<32m", "<64m", "<128m", "<256m", "<512m", "<1s", "<2s", ">2s"
+    };
+
+    fprintf( fp, "      %-6s", name );
+    for( int32_t b = 0; b < SIM_PROFILE_BUCKETS; b++ ) {
+      if( hist[b] )
+        fprintf( fp, " %s:%u", labels[b], hist[b] );
+    }
+    fprintf( fp, "\n" );
+}
+
+// one entry per callback, handlers sharing a callback are summed
+void
+sim::profileDump( FILE *fp ) {
+    bool    shown[SIM_EVENT_MAX] = {};
+    char    name[64], event[24];
+
+    fprintf( fp, "handler profile, %.1f mS\n", (now() - _profileStart) / 1000.0 );
+    fprintf( fp, "  %-24s %-16s %7s %7s %9s %9s %9s %9s\n",
+             "callback", "event", "count", "merged", "run avg", "run max", "wait avg", "wait max" );
+
+    for( int32_t i = 0; i < _poolUsed; i++ ) {
+      if( shown[i] )
+        continue;
+
+      const void *fn  = callbackOf( &_pool[i] );
+      profile     sum = _profile[i];
+      for( int32_t j = i + 1; j < _poolUsed; j++ ) {
+        if( shown[j] || callbackOf( &_pool[j] ) != fn )
+          continue;
+        const profile &p = _profile[j];
+        shown[j]        = true;
+        sum.count      += p.count;
+        sum.unstamped  += p.unstamped;
+        sum.merged     += p.merged;
+        sum.runTotal   += p.runTotal;
+        sum.queueTotal += p.queueTotal;
+        sum.runMax      = std::max( sum.runMax, p.runMax );
+        sum.queueMax    = std::max( sum.queueMax, p.queueMax );
+        for( int32_t b = 0; b < SIM_PROFILE_BUCKETS; b++ ) {
+          sum.runHist[b]   += p.runHist[b];
+          sum.queueHist[b] += p.queueHist[b];
+        }
+      }
+
+      uint32_t stamped = sum.count - sum.unstamped;
+      callbackName( fn, name, sizeof(name) );
+      eventName( _pool[i].index, _pool[i].mask, event, sizeof(event) );
+      fprintf( fp, "  %-24s %-16s %7u %7u %9.2f %9.2f %9.2f %9.2f\n", name, event, sum.count, sum.merged,
+               sum.count ? sum.runTotal / 1000.0 / sum.count : 0.0, sum.runMax / 1000.0,
+               stamped ? sum.queueTotal / 1000.0 / stamped : 0.0, sum.queueMax / 1000.0 );
+      if( sum.count ) {
+        histDump( fp, "run", sum.runHist );
+        histDump( fp, "wait", sum.queueHist );
+      }
+    }
+    fflush( fp );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Dispatch                                                                  */
+/*----------------------------------------------------------------------------*/
+
+static void
+handlerTask( void *arg ) {
+    handler *h = (handler *)arg;
+
+    for(;;) {
+      while( h->pending == 0 )
+        sim::taskBlock();
+
+      // triggers arriving while this waits fold into the pending one
+      if( h->policy.type == sim::coalesceType::interval && h->lastStart ) {
+        sim::usec_t next = h->lastStart + (sim::usec_t)h->policy.value * 1000;
+        if( sim::now() < next )
+          sim::taskSleepUntil( next );
+      }
+      h->pending--;
+      h->lastStart = sim::now();
+
+      h->running = true;
+      if( _profiling )
+        profileStart( h );
+      if( sim::trace.handlerStart )
+        sim::trace.handlerStart( h->index, h->mask );
+      if( h->callback )
+        h->callback();
+      else
+      if( h->callbackArg )
+        h->callbackArg( h->arg );
+      else
+      if( h->callbackInt )
+        h->callbackInt( h->index );
+      if( sim::trace.handlerEnd )
+        sim::trace.handlerEnd( h->index, h->mask );
+      if( _profiling )
+        profileEnd( h );
+      h->running = false;
+
+      h->done++;
+      if( _waitingCount )
+        finished( h );
+    }
+}
+
+static void
+registerHandler( int16_t index, uint32_t mask, void (* cb)(void), void (* cbarg)(void *), void (* cbint)(int), void *arg ) {
+    if( index < 0 || index >= SIM_INDEX_MAX ) {
+      fprintf( stderr, "sim: event index %d out of range\n", index );
+      return;
+    }
+    row &r = _rows[index];
+    if( r.used >= SIM_EVENT_SLOTS || _poolUsed >= SIM_EVENT_MAX ) {
+      fprintf( stderr, "sim: no room for another handler on event %d\n", index );
+      return;
+    }
+
+    handler *h = &_pool[_poolUsed++];
+    h->index       = index;
+    h->mask        = mask;
+    h->callback    = cb;
+    h->callbackArg = cbarg;
+    h->callbackInt = cbint;
+    h->arg         = arg;
+    h->task        = sim::taskCreate( handlerTask, h, task::taskPriorityNormal, NULL, "event" );
+
+    for( int32_t i = 0; i < _ruleCount; i++ ) {
+      if( ruleMatches( _rules[i], h ) )
+        h->policy = _rules[i].policy;
+    }
+
+    // slots are handed out in registration order, which is the order
+    // handlers run in when one broadcast wakes several
+    int32_t slot = r.used++;
+    h->slot       = slot;
+    r.slots[slot] = h;
+    for( int32_t b = 0; b < 32; b++ ) {
+      if( mask & (1u << b) )
+        r.bits[b] |= 1 << slot;
+    }
+}
+
+// false if a coalescing handler should not take this trigger at all
+static bool
+accept( handler *h, int32_t value ) {
+    if( h->policy.type == sim::coalesceType::hysteresis ) {
+      if( h->haveValue && abs( value - h->lastValue ) < h->policy.value )
+        return( false );
+      h->lastValue = value;
+      h->haveValue = true;
+    }
+    return( true );
+}
+
+// queue a trigger on every matching handler, returns the slots that
+// will run for it
+static uint32_t
+fire( int32_t index, uint32_t mask, int32_t value ) {
+    if( sim::trace.eventFire )
+      sim::trace.eventFire( index, mask );
+    if( index < 0 || index >= SIM_INDEX_MAX )
+      return( 0 );
+
+    row &r = _rows[index];
+    uint32_t hit = 0;
+    if( mask == 0xFFFFFFFF )
+      hit = (1 << r.used) - 1;
+    else {
+      for( uint32_t m = mask; m; m &= m - 1 )
+        hit |= r.bits[ __builtin_ctz( m ) ];
+    }
+
+    for( uint32_t m = hit; m; m &= m - 1 ) {
+      handler *h = r.slots[ __builtin_ctz( m ) ];
+      if( h->policy.type != sim::coalesceType::none ) {
+        if( !accept( h, value ) ) {
+          if( _profiling )
+            _profile[h - _pool].merged++;
+          hit &= ~(1 << h->slot);
+          continue;
+        }
+        if( h->pending ) {
+          if( _profiling )
+            _profile[h - _pool].merged++;
+          continue;
+        }
+      }
+      if( _profiling )
+        _profile[h - _pool].triggered[h->queued % SIM_PROFILE_DEPTH] = sim::now();
+      h->pending++;
+      h->queued++;
+      sim::taskWake( h->task );
+    }
+    return( hit );
+}
+
+void
+sim::eventFire( int32_t index, uint32_t mask, int32_t value ) {
+    fire( index, mask, value );
+}
+
+bool
+sim::eventCoalesce( int32_t index, uint32_t mask, const void *callback, coalescePolicy policy ) {
+    if( index < 0 || index >= SIM_INDEX_MAX || mask == 0 )
+      return( false );
+
+    int32_t i;
+    for( i = 0; i < _ruleCount; i++ ) {
+      if( _rules[i].index == index && _rules[i].mask == mask && _rules[i].callback == callback )
+        break;
+    }
+    if( i == _ruleCount ) {
+      if( _ruleCount >= SIM_COALESCE_MAX ) {
+        fprintf( stderr, "sim: too many coalescing rules\n" );
+        return( false );
+      }
+      _ruleCount++;
+    }
+    _rules[i] = { index, mask, callback, policy };
+
+    row &r = _rows[index];
+    for( int32_t s = 0; s < r.used; s++ ) {
+      handler *h = r.slots[s];
+      if( ruleMatches( _rules[i], h ) ) {
+        h->policy    = policy;
+        h->haveValue = false;
+      }
+    }
+    return( true );
+}
+
+const sim::eventWait &
+sim::eventLastWait() {
+    return( _lastWait );
+}
+
+/*----------------------------------------------------------------------------*/
+
+event::event() : _callback( NULL ) {
+    _userid = userindex();
+}
+
+event::event( int16_t index, uint32_t mask, void (* callback)(void) ) : _callback( callback ) {
+    _userid = index;
+    init( index, mask, callback );
+}
+
+event::event( void (* callback)(void) ) : event() {
+    set( callback );
+}
+
+event::event( event v, void (* callback)(void) ) : _callback( callback ) {
+    _userid = v._userid;
+    init( _userid, 1, callback );
+}
+
+event::event( void (* callback)(void *), void *arg ) : event() {
+    init( _userid, 1, callback, arg );
+}
+
+event::event( event v, void (* callback)(void *), void *arg ) : _callback( NULL ) {
+    _userid = v._userid;
+    init( _userid, 1, callback, arg );
+}
+
+event::~event() {
+}
+
+void
+event::init( int16_t index, uint32_t mask, void (* callback)(void) ) {
+    registerHandler( index, mask, callback, NULL, NULL, NULL );
+}
+
+void
+event::init( int16_t index, uint32_t mask, void (* callback)(int) ) {
+    registerHandler( index, mask, NULL, NULL, callback, NULL );
+}
+
+void
+event::init( int16_t index, uint32_t mask, void (* callback)(void *), void *arg ) {
+    registerHandler( index, mask, NULL, callback, NULL, arg );
+}
+
+int32_t
+event::userindex() {
+    return( _usereventid++ );
+}
+
+void
+event::set( void (* callback)(void) ) {
+    _callback = callback;
+    init( _userid, 1, callback );
+}
+
+void
+event::operator()( void (* callback)(void) ) {
+    set( callback );
+}
+
+void
+event::broadcast() {
+    broadcast( _userid );
+}
+
+void
+event::broadcastAndWait( int32_t timeout ) {
+    broadcastAndWait( _userid, timeout );
+}
+
+void
+event::broadcast( int16_t index ) {
+    fire( index, 0xFFFFFFFF, 0 );
+}
+
+void
+event::broadcastAndWait( int16_t index, int32_t timeout ) {
+    sim::usec_t start = sim::now();
+    waiter      w     = {};
+
+    w.index           = index;
+    w.task            = sim::taskCurrent();
+    w.result.index    = index;
+    w.result.last     = -1;
+
+    uint32_t hit = fire( index, 0xFFFFFFFF, 0 );
+    w.result.handlers = __builtin_popcount( hit );
+    for( uint32_t m = hit; m; m &= m - 1 ) {
+      int32_t slot = __builtin_ctz( m );
+      w.target[slot] = _rows[index].slots[slot]->queued;
+    }
+    w.outstanding = hit;
+
+    if( w.outstanding && timeout > 0 && w.task ) {
+      _waiting[_waitingCount++] = &w;
+      sim::usec_t deadline = start + (sim::usec_t)timeout * 1000;
+      while( w.outstanding && sim::taskBlockUntil( deadline ) )
+        ;
+      for( int32_t i = 0; i < _waitingCount; i++ ) {
+        if( _waiting[i] == &w ) {
+          _waiting[i] = _waiting[--_waitingCount];
+          break;
+        }
+      }
+    }
+
+    w.result.timedout = (w.outstanding != 0);
+    w.result.elapsed  = sim::now() - start;
+    _lastWait = w.result;
+}
@@ -0,0 +1,177 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_format.cpp
+//    Description:  Formats checked format strings, no printf involved
+//
+//----------------------------------------------------------------------------
+
+// The format has been checked against the arguments by the time it gets
+// here, so this only walks it once copying text and converting numbers.
+// Floats are converted as fixed point, scaled by 10^precision and rounded
+// to an integer, which is all the screen ever needs. A value exactly half
+// way rounds away from zero where printf would round it to even.
+
+#include <math.h>
+#include <string.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+namespace {
+  // writes into a fixed buffer, dropping whatever does not fit
+  struct output {
+    char   *buf;
+    size_t  len;
+    size_t  n;
+
+    void put( char c ) {
+      if( n + 1 < len )
+        buf[n] = c;
+      n++;
+    }
+    void fill( char c, int32_t count ) {
+      for( ; count > 0; count-- )
+        put( c );
+    }
+  };
+}
+
+static const uint64_t _pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// digits of v backwards into end, returns the first
+static char *
+digits( char *end, uint64_t v, uint32_t base, bool upper ) {
+    const char *set = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    do {
+      *--end = set[v % base];
+      v /= base;
+    } while( v );
+    return( end );
+}
+
+// body already converted, pad it out to the width
+static void
+field( output &out, const format::spec &s, const char *sign, const char *body, int32_t len ) {
+    int32_t signLen = sign ? 1 : 0;
+    int32_t pad     = s.width - len - signLen;
+
+    if( !s.left && !s.zero )
+      out.fill( ' ', pad );
+    if( sign )
+      out.put( *sign );
+    if( !s.left && s.zero )
+      out.fill( '0', pad );
+    for( int32_t i = 0; i < len; i++ )
+      out.put( body[i] );
+    if( s.left )
+      out.fill( ' ', pad );
+}
+
+static void
+integer( output &out, const format::spec &s, const format::arg &a ) {
+    char      tmp[24];
+    char     *end = tmp + sizeof(tmp);
+    char     *p;
+    uint64_t  v   = a.u;
+    bool      neg = false;
+
+    if( s.conversion == 'c' ) {
+      char c = (char)a.i;
+      field( out, s, NULL, &c, 1 );
+      return;
+    }
+
+    if( a.type == format::kind::sint && a.i < 0 ) {
+      if( s.conversion == 'd' || s.conversion == 'i' ) {
+        neg = true;
+        v   = 0 - (uint64_t)a.i;
+      }
+      else
+        // as printf does, a negative int shown unsigned is its 32 bit pattern
+        if( a.i >= INT32_MIN )
+          v = (uint32_t)a.i;
+    }
+
+    if( s.conversion == 'x' || s.conversion == 'X' )
+      p = digits( end, v, 16, s.conversion == 'X' );
+    else
+      p = digits( end, v, 10, false );
+    field( out, s, neg ? "-" : NULL, p, end - p );
+}
+
+static void
+real( output &out, const format::spec &s, double f ) {
+    char      tmp[32];
+    char     *end  = tmp + sizeof(tmp);
+    int32_t   prec = s.precision < 0 ? 6 : s.precision;
+    bool      neg  = signbit( f );
+
+    if( prec > 9 )
+      prec = 9;
+    if( neg )
+      f = -f;
+
+    if( isnan( f ) || isinf( f ) || f * _pow10[prec] >= 1.8e19 ) {
+      format::spec t = s;
+      t.zero = false;
+      const char *word = isnan( f ) ? "nan" : "inf";
+      field( out, t, neg ? "-" : NULL, word, 3 );
+      return;
+    }
+
+    uint64_t  v = (uint64_t)llround( f * _pow10[prec] );
+    uint64_t  whole = v / _pow10[prec];
+    uint64_t  frac  = v % _pow10[prec];
+    char     *p = end;
+    if( prec > 0 ) {
+      for( int32_t i = 0; i < prec; i++ ) {
+        *--p = '0' + frac % 10;
+        frac /= 10;
+      }
+      *--p = '.';
+    }
+    p = digits( p, whole, 10, false );
+    field( out, s, neg ? "-" : NULL, p, end - p );
+}
+
+int32_t
+format::render( char *buf, size_t len, const char *format, const arg *args, size_t count ) {
+    output  out = { buf, len, 0 };
+    size_t  n   = 0;
+
+    for( const char *p = format; *p; ) {
+      if( *p != '%' ) {
+        out.put( *p++ );
+        continue;
+      }
+      p++;
+      if( *p == '%' ) {
+        out.put( *p++ );
+        continue;
+      }
+      spec s = parse( p );
+      if( n >= count )
+        break;
+      const arg &a = args[n++];
+      if( s.conversion == 's' ) {
+        // a precision is the most of the string printed, as in printf
+        const char *text = a.s ? a.s : "(null)";
+        size_t      most = s.precision < 0 ? SIZE_MAX : (size_t)s.precision;
+        field( out, s, NULL, text, strnlen( text, most ) );
+      }
+      else
+      if( s.conversion == 'f' )
+        real( out, s, a.f );
+      else
+        integer( out, s, a );
+    }
+
+    if( len ) {
+      size_t end = out.n < len ? out.n : len - 1;
+      buf[end] = 0;
+    }
+    return( out.n < len ? out.n : (len ? len - 1 : 0) );
+}
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_global.cpp
+//    Description:  Definitions for the globals in vex_global.h
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+namespace vex {
+    const rotationUnits         degrees       = rotationUnits::deg;
+    const rotationUnits         turns         = rotationUnits::rev;
+    const percentUnits          percent       = percentUnits::pct;
+    const timeUnits             seconds       = timeUnits::sec;
+    const distanceUnits         inches        = distanceUnits::in;
+    const distanceUnits         mm            = distanceUnits::mm;
+    const directionType         forward       = directionType::fwd;
+    const directionType         reverse       = directionType::rev;
+    const turnType              left          = turnType::left;
+    const turnType              right         = turnType::right;
+
+    const colorType             black         = colorType::black;
+    const colorType             white         = colorType::white;
+    const colorType             red           = colorType::red;
+    const colorType             green         = colorType::green;
+    const colorType             blue          = colorType::blue;
+    const colorType             yellow        = colorType::yellow;
+    const colorType             orange        = colorType::orange;
+    const colorType             purple        = colorType::purple;
+    const colorType             cyan          = colorType::cyan;
+    const colorType             transparent   = colorType::transparent;
+
+    const colorType             red_violet    = colorType::red_violet;
+    const colorType             violet        = colorType::violet;
+    const colorType             blue_violet   = colorType::blue_violet;
+    const colorType             blue_green    = colorType::blue_green;
+    const colorType             yellow_green  = colorType::yellow_green;
+    const colorType             yellow_orange = colorType::yellow_orange;
+    const colorType             red_orange    = colorType::red_orange;
+
+    const fadeType              slow          = fadeType::slow;
+    const fadeType              fast          = fadeType::fast;
+    const fadeType              off           = fadeType::off;
+
+    const gyroCalibrationType   calNormal     = gyroCalibrationType::calNormal;
+    const gyroCalibrationType   calSlow       = gyroCalibrationType::calSlow;
+    const gyroCalibrationType   calExtended   = gyroCalibrationType::calExtended;
+
+    const soundType             siren         = soundType::siren;
+    const soundType             wrongWay      = soundType::wrongWay;
+    const soundType             wrongWaySlow  = soundType::wrongWaySlow;
+    const soundType             fillup        = soundType::fillup;
+    const soundType             headlightsOn  = soundType::headlightsOn;
+    const soundType             headlightsOff = soundType::headlightsOff;
+    const soundType             tollBooth     = soundType::tollBooth;
+    const soundType             alarm         = soundType::alarm;
+    const soundType             tada          = soundType::tada;
+    const soundType             doorClose     = soundType::doorClose;
+    const soundType             ratchet       = soundType::ratchet;
+    const soundType             wrench        = soundType::wrench;
+    const soundType             siren2        = soundType::siren2;
+    const soundType             ratchet2      = soundType::ratchet2;
+    const soundType             alarm2        = soundType::alarm2;
+    const soundType             powerDown     = soundType::powerDown;
+
+    // ports are zero based
+    const int32_t               PORT1         = 0;
+    const int32_t               PORT2         = 1;
+    const int32_t               PORT3         = 2;
+    const int32_t               PORT4         = 3;
+    const int32_t               PORT5         = 4;
+    const int32_t               PORT6         = 5;
+    const int32_t               PORT7         = 6;
+    const int32_t               PORT8         = 7;
+    const int32_t               PORT9         = 8;
+    const int32_t               PORT10        = 9;
+    const int32_t               PORT11        = 10;
+    const int32_t               PORT12        = 11;
+
+    const percentUnits          pct           = percentUnits::pct;
+    const timeUnits             sec           = timeUnits::sec;
+    const timeUnits             msec          = timeUnits::msec;
+    const voltageUnits          volt          = voltageUnits::volt;
+    const currentUnits          amp           = currentUnits::amp;
+    const powerUnits            watt          = powerUnits::watt;
+    const torqueUnits           Nm            = torqueUnits::Nm;
+    const torqueUnits           InLb          = torqueUnits::InLb;
+    const rotationUnits         deg           = rotationUnits::deg;
+    const rotationUnits         rev           = rotationUnits::rev;
+    const velocityUnits         rpm           = velocityUnits::rpm;
+    const velocityUnits         dps           = velocityUnits::dps;
+    const temperatureUnits      celsius       = temperatureUnits::celsius;
+    const temperatureUnits      fahrenheit    = temperatureUnits::fahrenheit;
+
+    const directionType         fwd           = directionType::fwd;
+    const brakeType             coast         = brakeType::coast;
+    const brakeType             brake         = brakeType::brake;
+    const brakeType             hold          = brakeType::hold;
+
+    void
+    wait( double time, timeUnits units ) {
+      if( units == timeUnits::sec )
+        time *= 1000;
+      task::sleep( (uint32_t)(time + 0.5) );
+    }
+};
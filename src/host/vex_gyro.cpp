@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_gyro.cpp
+//    Description:  Host implementation of vex::gyro
+//
+//----------------------------------------------------------------------------
+
+// The port holds the angle turned counterclockwise since the gyro started,
+// set with sim::setGyro. Readings are taken from the frame in tenths of a
+// degree, as the sensor reports them, with the sign flipped for a gyro
+// that counts turning right as positive. Heading and rotation are that less
+// their own offsets, so setting one leaves the other alone. Calibration
+// takes no time, it only makes where the gyro is now read as zero.
+
+#include <math.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+gyro::gyro( int32_t index, bool calibrate, turnType dir ) : device( index ) {
+    _absolute    = 0;
+    _value       = 0;
+    _offset_h    = 0;
+    _offset_r    = 0;
+    _rate        = 0;
+    _calInit     = false;
+    _mode        = dir == turnType::right ? 1 : 0;
+    setSensitivity( tSensitivity::normal );
+    setPollInterval( 20 );
+    sim::portInstall( index, kDeviceTypeGyroSensor );
+    if( calibrate )
+      startCalibration();
+}
+
+gyro::~gyro() {
+}
+
+bool
+gyro::installed() {
+    return( type() == kDeviceTypeGyroSensor );
+}
+
+// the reading from this tick's frame, not the port itself
+void
+gyro::getAngleAndRate() {
+    if( _index < 0 || _index >= IQ_MAX_DEVICE_PORTS )
+      return;
+    const sim::gyroState &g = sim::frameGet().ports[_index].gyro;
+    int32_t sign = _mode ? -1 : 1;
+    _absolute = sign * (int32_t)lround( g.angle * 10 );
+    _rate     = sign * (int32_t)lround( g.rate * 10 );
+    _value    = _absolute - _offset_h;
+}
+
+int32_t
+gyro::value() {
+    return( (int32_t)lround( heading( rotationUnits::deg ) ) );
+}
+
+double
+gyro::value( rotationUnits units ) {
+    return( heading( units ) );
+}
+
+bool
+gyro::startCalibration( gyroCalibrationType value, bool waitForCompletion ) {
+    getAngleAndRate();
+    _offset_h = _absolute;
+    _offset_r = _absolute;
+    _calInit  = true;
+    return( true );
+}
+
+bool
+gyro::isCalibrating() {
+    return( calibrationFlagGet() );
+}
+
+bool
+gyro::calibrationFlagGet() {
+    return( false );
+}
+
+void
+gyro::resetHeading() {
+    setHeading( 0, rotationUnits::deg );
+}
+
+void
+gyro::resetRotation() {
+    setRotation( 0, rotationUnits::deg );
+}
+
+void
+gyro::setHeading( double value, rotationUnits units ) {
+    getAngleAndRate();
+    _offset_h = _absolute - angleToRaw( value, units );
+}
+
+void
+gyro::setRotation( double value, rotationUnits units ) {
+    getAngleAndRate();
+    _offset_r = _absolute - angleToRaw( value, units );
+}
+
+double
+gyro::angle( rotationUnits units ) {
+    return( heading( units ) );
+}
+
+// 0 to 360 degrees
+double
+gyro::heading( rotationUnits units ) {
+    getAngleAndRate();
+    int32_t raw = _value % 3600;
+    if( raw < 0 )
+      raw += 3600;
+    return( rawToAngle( raw, units ) );
+}
+
+double
+gyro::rotation( rotationUnits units ) {
+    getAngleAndRate();
+    return( rawToAngle( _absolute - _offset_r, units ) );
+}
+
+double
+gyro::rate( rateUnits units ) {
+    getAngleAndRate();
+    return( units == rateUnits::rps ? _rate / 3600.0 : _rate / 10.0 );
+}
+
+void
+gyro::changed( void (* callback)(void) ) {
+    event::init( _index, (uint32_t)tEventType::EVENT_CHANGED, callback );
+}
+
+void
+gyro::setTurnType( turnType dir ) {
+    _mode = dir == turnType::right ? 1 : 0;
+}
+
+turnType
+gyro::getTurnType() {
+    return( _mode ? turnType::right : turnType::left );
+}
+
+void
+gyro::setSensitivity( tSensitivity s ) {
+    _sensitivity = s;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  raw units are tenths of a degree                                          */
+/*----------------------------------------------------------------------------*/
+
+double
+gyro::rawToAngle( int32_t raw, rotationUnits units ) {
+    switch( units ) {
+      case rotationUnits::rev: return( raw / 3600.0 );
+      case rotationUnits::raw: return( raw );
+      default:                 return( raw / 10.0 );
+    }
+}
+
+int32_t
+gyro::angleToRaw( double angle, rotationUnits units ) {
+    switch( units ) {
+      case rotationUnits::rev: return( (int32_t)lround( angle * 3600 ) );
+      case rotationUnits::raw: return( (int32_t)lround( angle ) );
+      default:                 return( (int32_t)lround( angle * 10 ) );
+    }
+}
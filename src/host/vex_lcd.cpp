@@ -0,0 +1,537 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_lcd.cpp
+//    Description:  Host implementation of brain::lcd on a 128x64 panel
+//
+//----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+// The drawing buffer is one bit per pixel, a row is two 64 bit words with
+// x = 0 in bit 0 of the first. Everything is drawn as horizontal spans, a
+// span sets, clears or flips whole words at a time with masks at the ends,
+// so rectangles, inverts and circles cost a few word operations per row
+// rather than one store per pixel.
+//
+// _shown is what the screen has been sent. Drawing widens a per page dirty
+// span so the push only compares what was touched, clearing and
+// reprinting the same text costs a compare and no bytes.
+
+#define ROW_WORDS     (SIM_LCD_WIDTH / 64)
+
+static uint64_t       _panel[SIM_LCD_HEIGHT][ROW_WORDS];
+static uint8_t        _shown[SIM_LCD_WIDTH * SIM_LCD_PAGES];
+static int16_t        _dirtyLo[SIM_LCD_PAGES];
+static int16_t        _dirtyHi[SIM_LCD_PAGES] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+static sim::lcdStats  _stats;
+
+#define CHAR_WIDTH    6   // 5 pixel glyph plus one space
+
+// 5x7 font for 0x20 to 0x7E, one byte per column, bit 0 at the top
+static const uint8_t _font[][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, // ' ' !
+    { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, // " #
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // $ %
+    { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, // & '
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, // ( )
+    { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // * +
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, // , -
+    { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 }, // . /
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // 0 1
+    { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, // 2 3
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, // 4 5
+    { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 6 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, // 8 9
+    { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 }, // : ;
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // < =
+    { 0x41, 0x22, 0x14, 0x08, 0x00 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, // > ?
+    { 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, // @ A
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // B C
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, // D E
+    { 0x7F, 0x09, 0x09, 0x01, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x32 }, // F G
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // H I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // J K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x04, 0x02, 0x7F }, // L M
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // N O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, // P Q
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 }, // R S
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // T U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F }, // V W
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, // X Y
+    { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x00, 0x7F, 0x41, 0x41 }, // Z [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x41, 0x41, 0x7F, 0x00, 0x00 }, // \ ]
+    { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }, // ^ _
+    { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 }, // ` a
+    { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 }, // b c
+    { 0x38, 0x44, 0x44, 0x48, 0x7F }, { 0x38, 0x54, 0x54, 0x54, 0x18 }, // d e
+    { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x08, 0x14, 0x54, 0x54, 0x3C }, // f g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, // h i
+    { 0x20, 0x40, 0x44, 0x3D, 0x00 }, { 0x00, 0x7F, 0x10, 0x28, 0x44 }, // j k
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 }, // l m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, // n o
+    { 0x7C, 0x14, 0x14, 0x14, 0x08 }, { 0x08, 0x14, 0x14, 0x18, 0x7C }, // p q
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 }, // r s
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, // t u
+    { 0x1C, 0x20, 0x40, 0x20, 0x1C }, { 0x3C, 0x40, 0x30, 0x40, 0x3C }, // v w
+    { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C }, // x y
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, // z {
+    { 0x00, 0x00, 0x7F, 0x00, 0x00 }, { 0x00, 0x41, 0x36, 0x08, 0x00 }, // | }
+    { 0x10, 0x08, 0x08, 0x10, 0x08 }                                    // ~
+};
+
+/*----------------------------------------------------------------------------*/
+/*  Rasterizer                                                                */
+/*----------------------------------------------------------------------------*/
+
+enum class spanOp { clear, set, flip };
+
+static inline void
+dirty( int x0, int x1, int y ) {
+    int page = y >> 3;
+    if( _dirtyHi[page] < 0 ) {
+      _dirtyLo[page] = x0;
+      _dirtyHi[page] = x1;
+      return;
+    }
+    if( x0 < _dirtyLo[page] )
+      _dirtyLo[page] = x0;
+    if( x1 > _dirtyHi[page] )
+      _dirtyHi[page] = x1;
+}
+
+static void
+dirtyAll() {
+    for( int page = 0; page < SIM_LCD_PAGES; page++ ) {
+      _dirtyLo[page] = 0;
+      _dirtyHi[page] = SIM_LCD_WIDTH - 1;
+    }
+}
+
+// pixels x0 to x1 inclusive on row y, clipped
+static inline void
+span( int x0, int x1, int y, spanOp op ) {
+    if( y < 0 || y >= SIM_LCD_HEIGHT )
+      return;
+    if( x0 < 0 )
+      x0 = 0;
+    if( x1 >= SIM_LCD_WIDTH )
+      x1 = SIM_LCD_WIDTH - 1;
+    if( x0 > x1 )
+      return;
+
+    uint64_t *row = _panel[y];
+    for( int w = x0 >> 6; w <= x1 >> 6; w++ ) {
+      int      lo   = (w == x0 >> 6) ? (x0 & 63) : 0;
+      int      hi   = (w == x1 >> 6) ? (x1 & 63) : 63;
+      uint64_t mask = (~0ULL << lo) & (~0ULL >> (63 - hi));
+      switch( op ) {
+        case spanOp::clear: row[w] &= ~mask; break;
+        case spanOp::set:   row[w] |=  mask; break;
+        case spanOp::flip:  row[w] ^=  mask; break;
+      }
+    }
+    dirty( x0, x1, y );
+}
+
+static inline void
+plot( int x, int y, bool on ) {
+    span( x, x, y, on ? spanOp::set : spanOp::clear );
+}
+
+static void
+fillRect( int x, int y, int w, int h, bool on ) {
+    for( int j = y; j < y + h; j++ )
+      span( x, x + w - 1, j, on ? spanOp::set : spanOp::clear );
+}
+
+static void
+invertRect( int x, int y, int w, int h ) {
+    for( int j = y; j < y + h; j++ )
+      span( x, x + w - 1, j, spanOp::flip );
+}
+
+// up to 8 pixels from bits, bit 0 at x, set where on and cleared elsewhere
+static inline void
+blit( int x, int y, uint32_t bits, int n, bool fg ) {
+    if( y < 0 || y >= SIM_LCD_HEIGHT || x >= SIM_LCD_WIDTH || x + n <= 0 )
+      return;
+    for( int i = 0; i < n; i++ ) {
+      int px = x + i;
+      if( px < 0 || px >= SIM_LCD_WIDTH )
+        continue;
+      uint64_t m = 1ULL << (px & 63);
+      if( (((bits >> i) & 1) != 0) == fg )
+        _panel[y][px >> 6] |= m;
+      else
+        _panel[y][px >> 6] &= ~m;
+    }
+    dirty( x < 0 ? 0 : x, x + n - 1 >= SIM_LCD_WIDTH ? SIM_LCD_WIDTH - 1 : x + n - 1, y );
+}
+
+static inline bool
+pixel( int x, int y ) {
+    return( (_panel[y][x >> 6] >> (x & 63)) & 1 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Panel                                                                     */
+/*----------------------------------------------------------------------------*/
+
+bool
+sim::lcdPixel( int32_t x, int32_t y ) {
+    if( x < 0 || x >= SIM_LCD_WIDTH || y < 0 || y >= SIM_LCD_HEIGHT )
+      return( false );
+    return( pixel( x, y ) );
+}
+
+// columns x to x + 7 of a page as the display controller stores them, one
+// byte per column with bit 0 at the top. The 8x8 block is gathered one row
+// per byte and transposed in a word.
+static inline uint64_t
+columns( int page, int x ) {
+    uint64_t b = 0;
+    for( int j = 0; j < 8; j++ )
+      b |= ((_panel[page * 8 + j][x >> 6] >> (x & 63)) & 0xFF) << (8 * j);
+
+    uint64_t t;
+    t = (b ^ (b >>  7)) & 0x00AA00AA00AA00AAULL;  b ^= t ^ (t <<  7);
+    t = (b ^ (b >> 14)) & 0x0000CCCC0000CCCCULL;  b ^= t ^ (t << 14);
+    t = (b ^ (b >> 28)) & 0x00000000F0F0F0F0ULL;  b ^= t ^ (t << 28);
+    return( b );
+}
+
+void
+sim::lcdPush() {
+    uint32_t bytes = 0;
+
+    for( int page = 0; page < SIM_LCD_PAGES; page++ ) {
+      if( _dirtyHi[page] < 0 )
+        continue;
+
+      int first = -1, last = -1;
+      for( int x = _dirtyLo[page] & ~7; x <= _dirtyHi[page]; x += 8 ) {
+        uint64_t  now = columns( page, x );
+        uint8_t  *was = &_shown[page * SIM_LCD_WIDTH + x];
+        uint64_t  old;
+        memcpy( &old, was, 8 );
+        if( now == old )
+          continue;
+        memcpy( was, &now, 8 );
+
+        // only the bytes that changed count as sent
+        uint64_t diff = now ^ old;
+        if( first < 0 )
+          first = x + __builtin_ctzll( diff ) / 8;
+        last = x + (63 - __builtin_clzll( diff )) / 8;
+      }
+      if( first >= 0 )
+        bytes += SIM_LCD_PAGE_SETUP + (last - first + 1);
+      _dirtyHi[page] = -1;
+    }
+
+    if( bytes ) {
+      _stats.frames++;
+      _stats.lastBytes  = bytes;
+      _stats.bytes     += bytes;
+      _stats.fullBytes += SIM_LCD_PAGES * (SIM_LCD_PAGE_SETUP + SIM_LCD_WIDTH);
+    }
+}
+
+const sim::lcdStats &
+sim::lcdStatsGet() {
+    return( _stats );
+}
+
+// what the screen shows, two pixel rows per line using half blocks
+void
+sim::lcdDump( FILE *fp ) {
+    for( int y = 0; y < SIM_LCD_HEIGHT; y += 2 ) {
+      for( int x = 0; x < SIM_LCD_WIDTH; x++ ) {
+        uint8_t b   = _shown[(y >> 3) * SIM_LCD_WIDTH + x];
+        bool    top = b & (1 << (y & 7));
+        bool    bot = b & (2 << (y & 7));
+        fputs( top ? (bot ? "█" : "▀") : (bot ? "▄" : " "), fp );
+      }
+      fputc( '\n', fp );
+    }
+}
+
+// the drawing buffer as a binary PBM, 1 is black and the first pixel of a
+// row is the top bit of its first byte
+void
+sim::lcdSavePbm( FILE *fp ) {
+    fprintf( fp, "P4\n%d %d\n", SIM_LCD_WIDTH, SIM_LCD_HEIGHT );
+    for( int y = 0; y < SIM_LCD_HEIGHT; y++ ) {
+      for( int x = 0; x < SIM_LCD_WIDTH; x += 8 ) {
+        uint8_t b = 0;
+        for( int i = 0; i < 8; i++ )
+          if( pixel( x + i, y ) )
+            b |= 0x80 >> i;
+        fputc( b, fp );
+      }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  lcd                                                                       */
+/*----------------------------------------------------------------------------*/
+
+brain::lcd::lcd() {
+    _row                 = 1;
+    _maxrows             = 5;
+    _rowheight           = 12;
+    _col                 = 1;
+    _maxcols             = 21;
+    _penWidth            = 1;
+    _textStr[0]          = 0;
+    _fg_color            = true;
+    _bg_color            = false;
+    _transparent         = false;
+    _aspect_compensation = false;
+    _origin_x            = 0;
+    _origin_y            = 0;
+}
+
+// top of the glyph for a text row
+int32_t
+brain::lcd::rowToPixel( int32_t row ) {
+    return( (row - 1) * _rowheight + 3 );
+}
+
+int32_t
+brain::lcd::colToPixel( int32_t col ) {
+    return( (col - 1) * CHAR_WIDTH + 1 );
+}
+
+// IQ panel pixels are taller than they are wide
+int32_t
+brain::lcd::scaley( int32_t y ) {
+    return( _aspect_compensation ? (y * 3) / 4 : y );
+}
+
+void
+brain::lcd::setCursor( int32_t row, int32_t col ) {
+    _row = row;
+    _col = col;
+}
+
+void
+brain::lcd::setPenWidth( uint32_t width ) {
+    _penWidth = width;
+}
+
+void
+brain::lcd::setOrigin( int32_t x, int32_t y ) {
+    _origin_x = x;
+    _origin_y = y;
+}
+
+void
+brain::lcd::setAspectCompensation( bool value ) {
+    _aspect_compensation = value;
+}
+
+int32_t
+brain::lcd::column() {
+    return( _col );
+}
+
+int32_t
+brain::lcd::row() {
+    return( _row );
+}
+
+void
+brain::lcd::setPenColor( colorType color ) {
+    _fg_color = (color != colorType::white && color != colorType::transparent);
+}
+
+void
+brain::lcd::setFillColor( colorType color ) {
+    _transparent = (color == colorType::transparent);
+    _bg_color    = (color != colorType::white && !_transparent);
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Text                                                                      */
+/*----------------------------------------------------------------------------*/
+
+static void
+drawChar( int x, int y, int rowheight, char c, bool fg ) {
+    if( c < 0x20 || c > 0x7E )
+      c = '?';
+    const uint8_t *glyph = _font[c - 0x20];
+
+    // clear the whole cell so text overwrites what was there, then the
+    // glyph a row at a time
+    fillRect( x, y - 3, CHAR_WIDTH, rowheight, !fg );
+    for( int j = 0; j < 7; j++ ) {
+      uint32_t bits = 0;
+      for( int i = 0; i < 5; i++ )
+        if( glyph[i] & (1 << j) )
+          bits |= 1 << i;
+      blit( x, y + j, bits, CHAR_WIDTH, fg );
+    }
+}
+
+// text already formatted into the row, '\n' starts the next line
+void
+brain::lcd::drawText( const char *str ) {
+    for( const char *p = str; *p; p++ ) {
+      if( *p == '\n' ) {
+        newLine();
+        continue;
+      }
+      if( _col > _maxcols || _row < 1 || _row > _maxrows )
+        continue;
+      drawChar( colToPixel( _col ), rowToPixel( _row ), _rowheight, *p, _fg_color );
+      _col++;
+    }
+}
+
+void
+brain::lcd::clearScreen() {
+    memset( _panel, 0, sizeof(_panel) );
+    dirtyAll();
+    setCursor( 1, 1 );
+}
+
+void
+brain::lcd::clearLine( int number ) {
+    fillRect( 0, rowToPixel( number ) - 3, SIM_LCD_WIDTH, _rowheight, false );
+}
+
+void
+brain::lcd::clearLine() {
+    int x = colToPixel( _col );
+    fillRect( x, rowToPixel( _row ) - 3, SIM_LCD_WIDTH - x, _rowheight, false );
+}
+
+void
+brain::lcd::newLine() {
+    _row++;
+    _col = 1;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Drawing, user coordinates are relative to the origin                      */
+/*----------------------------------------------------------------------------*/
+
+void
+brain::lcd::drawPixel( int x, int y ) {
+    fillRect( _origin_x + x, _origin_y + scaley( y ), _penWidth, _penWidth, _fg_color );
+}
+
+void
+brain::lcd::drawLine( int x1, int y1, int x2, int y2 ) {
+    int dx =  abs( x2 - x1 ), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs( y2 - y1 ), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+
+    for(;;) {
+      drawPixel( x1, y1 );
+      if( x1 == x2 && y1 == y2 )
+        break;
+      int e2 = 2 * err;
+      if( e2 >= dy ) { err += dy; x1 += sx; }
+      if( e2 <= dx ) { err += dx; y1 += sy; }
+    }
+}
+
+void
+brain::lcd::drawRectangle( int x, int y, int width, int height ) {
+    int px = _origin_x + x;
+    int py = _origin_y + scaley( y );
+    int h  = scaley( height );
+
+    if( !_transparent )
+      fillRect( px, py, width, h, _bg_color );
+
+    // outline with the pen
+    int pw = _penWidth;
+    fillRect( px,             py,         width, pw, _fg_color );
+    fillRect( px,             py + h - pw, width, pw, _fg_color );
+    fillRect( px,             py,         pw,    h,  _fg_color );
+    fillRect( px + width - pw, py,         pw,    h,  _fg_color );
+}
+
+void
+brain::lcd::drawRectangle( int x, int y, int width, int height, colorType color ) {
+    bool saveFill  = _bg_color;
+    bool saveTrans = _transparent;
+    setFillColor( color );
+    drawRectangle( x, y, width, height );
+    _bg_color    = saveFill;
+    _transparent = saveTrans;
+}
+
+void
+brain::lcd::invertRectangle( int x, int y, int width, int height ) {
+    int px = _origin_x + x;
+    int py = _origin_y + scaley( y );
+    invertRect( px, py, width, scaley( height ) );
+}
+
+// largest i with i * i + j * j <= r2
+static inline int
+halfWidth( int r2, int j ) {
+    int w = (int)sqrt( (double)(r2 - j * j) );
+    while( w * w + j * j > r2 )
+      w--;
+    while( (w + 1) * (w + 1) + j * j <= r2 )
+      w++;
+    return( w );
+}
+
+void
+brain::lcd::drawCircle( int x, int y, int radius ) {
+    int cx = _origin_x + x;
+    int cy = _origin_y + scaley( y );
+    int r2 = radius * radius;
+    int ri = radius - _penWidth;
+    int i2 = ri > 0 ? ri * ri : 0;
+
+    // per row the outline is the part of the outer disc outside the inner
+    // one, the fill is the inner disc
+    spanOp fg = _fg_color ? spanOp::set : spanOp::clear;
+    spanOp bg = _bg_color ? spanOp::set : spanOp::clear;
+    for( int j = -radius; j <= radius; j++ ) {
+      int y  = cy + scaley( j );
+      int wo = halfWidth( r2, j );
+      if( ri <= 0 || j * j > i2 ) {
+        span( cx - wo, cx + wo, y, fg );
+        continue;
+      }
+      int wi = halfWidth( i2, j );
+      span( cx - wo, cx - wi - 1, y, fg );
+      span( cx + wi + 1, cx + wo, y, fg );
+      if( !_transparent )
+        span( cx - wi, cx + wi, y, bg );
+    }
+}
+
+void
+brain::lcd::drawCircle( int x, int y, int radius, colorType color ) {
+    bool saveFill  = _bg_color;
+    bool saveTrans = _transparent;
+    setFillColor( color );
+    drawCircle( x, y, radius );
+    _bg_color    = saveFill;
+    _transparent = saveTrans;
+}
+
+void
+brain::lcd::invertCircle( int x, int y, int radius ) {
+    int cx = _origin_x + x;
+    int cy = _origin_y + scaley( y );
+    for( int j = -radius; j <= radius; j++ ) {
+      int w = halfWidth( radius * radius, j );
+      span( cx - w, cx + w, cy + j, spanOp::flip );
+    }
+}
@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_log.cpp
+//    Description:  Host implementation of vex::logger, a ring of raw records
+//
+//----------------------------------------------------------------------------
+
+// Writers reserve space by moving _head on with a compare and swap, fill
+// in the record and store its header last. The drain task is the only
+// reader, it stops at the first header that is still zero, so a record
+// that has been reserved but not finished holds up the ones after it
+// rather than being read half written. Words are zeroed as they are read
+// and _tail only moves once they are, so a writer never sees a stale
+// header in space it reserves.
+
+#include <string.h>
+
+#include <atomic>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+#define LOG_MASK        (SIM_LOG_WORDS - 1)
+#define LOG_FIXED       3     // header, format, time
+#define LOG_RECORD_MAX  (LOG_FIXED + 8 * (1 + (SIM_LOG_TEXT + 8) / 8))
+
+static_assert( (SIM_LOG_WORDS & LOG_MASK) == 0, "SIM_LOG_WORDS must be a power of 2" );
+
+static std::atomic<uint64_t>  _ring[SIM_LOG_WORDS];
+static std::atomic<uint64_t>  _head;
+static std::atomic<uint64_t>  _tail;
+static std::atomic<uint32_t>  _dropped;
+static uint32_t               _sent;      // only the drain moves this
+
+// raw records go here instead of being formatted, with the format strings
+// each written once before the first record that uses them
+static FILE                  *_file;
+static const char            *_formats[SIM_LOG_FORMATS];
+static int32_t                _formatCount;
+
+// words a string argument takes after its length, with the terminator
+static inline uint32_t
+textWords( size_t len ) {
+    return( (uint32_t)(len + 8) / 8 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Writers                                                                   */
+/*----------------------------------------------------------------------------*/
+
+bool
+logger::put( sink to, const char *format, const format::arg *args, size_t count ) {
+    size_t   lens[8];
+    uint32_t n     = LOG_FIXED + count;
+    uint64_t kinds = 0;
+
+    for( size_t i = 0; i < count; i++ ) {
+      kinds |= (uint64_t)args[i].type << (4 * i);
+      if( args[i].type == format::kind::text ) {
+        lens[i] = args[i].s ? strnlen( args[i].s, SIM_LOG_TEXT ) : 0;
+        n += textWords( lens[i] );
+      }
+    }
+
+    uint64_t h = _head.load( std::memory_order_relaxed );
+    do {
+      if( h + n - _tail.load( std::memory_order_acquire ) > SIM_LOG_WORDS ) {
+        _dropped.fetch_add( 1, std::memory_order_relaxed );
+        return( false );
+      }
+    } while( !_head.compare_exchange_weak( h, h + n, std::memory_order_relaxed ) );
+
+    uint64_t w = h + 1;
+    _ring[w++ & LOG_MASK].store( (uint64_t)(uintptr_t)format, std::memory_order_relaxed );
+    _ring[w++ & LOG_MASK].store( sim::now(), std::memory_order_relaxed );
+    for( size_t i = 0; i < count; i++ ) {
+      if( args[i].type != format::kind::text ) {
+        _ring[w++ & LOG_MASK].store( args[i].u, std::memory_order_relaxed );
+        continue;
+      }
+      _ring[w++ & LOG_MASK].store( lens[i], std::memory_order_relaxed );
+      for( uint32_t j = 0; j < textWords( lens[i] ); j++ ) {
+        uint64_t word = 0;
+        size_t   k    = j * 8;
+        if( k < lens[i] )
+          memcpy( &word, args[i].s + k, lens[i] - k < 8 ? lens[i] - k : 8 );
+        _ring[w++ & LOG_MASK].store( word, std::memory_order_relaxed );
+      }
+    }
+
+    // publishing the header is what makes the record visible
+    uint64_t header = n | (uint64_t)to << 16 | (uint64_t)count << 24 | kinds << 32;
+    _ring[h & LOG_MASK].store( header, std::memory_order_release );
+    return( true );
+}
+
+uint32_t
+logger::dropped() {
+    return( _dropped.load( std::memory_order_relaxed ) );
+}
+
+uint32_t
+logger::sent() {
+    return( _sent );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Reader                                                                    */
+/*----------------------------------------------------------------------------*/
+
+int32_t
+sim::logRender( const uint64_t *rec, const char *format, char *buf, size_t len ) {
+    format::arg args[8];
+    uint32_t    count = (rec[0] >> 24) & 0xFF;
+    const uint64_t *w = rec + LOG_FIXED;
+
+    for( uint32_t i = 0; i < count && i < 8; i++ ) {
+      args[i].type = (format::kind)((rec[0] >> (32 + 4 * i)) & 0xF);
+      if( args[i].type == format::kind::text ) {
+        uint64_t n = *w++;
+        args[i].s  = (const char *)w;
+        w += textWords( n );
+      }
+      else
+        args[i].u = *w++;
+    }
+    return( format::render( buf, len, format, args, count ) );
+}
+
+static void
+fileWord( uint64_t word ) {
+    fwrite( &word, sizeof(word), 1, _file );
+}
+
+static void
+fileFormat( const char *format ) {
+    for( int32_t i = 0; i < _formatCount; i++ )
+      if( _formats[i] == format )
+        return;
+    if( _formatCount < SIM_LOG_FORMATS )
+      _formats[_formatCount++] = format;
+
+    size_t len = strlen( format );
+    fileWord( 0 );
+    fileWord( (uint64_t)(uintptr_t)format );
+    fileWord( len );
+    for( uint32_t j = 0; j < textWords( len ); j++ ) {
+      uint64_t word = 0;
+      size_t   k    = j * 8;
+      if( k < len )
+        memcpy( &word, format + k, len - k < 8 ? len - k : 8 );
+      fileWord( word );
+    }
+}
+
+uint32_t
+logger::drain( uint32_t max ) {
+    uint64_t  rec[LOG_RECORD_MAX];
+    char      text[256];
+    uint32_t  sent = 0;
+    uint64_t  t    = _tail.load( std::memory_order_relaxed );
+
+    while( max == 0 || sent < max ) {
+      uint64_t header = _ring[t & LOG_MASK].load( std::memory_order_acquire );
+      if( header == 0 )
+        break;
+
+      // copy out so the record is contiguous, and free the space
+      uint32_t n = SIM_LOG_LENGTH( header );
+      for( uint32_t i = 0; i < n; i++ ) {
+        rec[i] = _ring[(t + i) & LOG_MASK].load( std::memory_order_relaxed );
+        _ring[(t + i) & LOG_MASK].store( 0, std::memory_order_relaxed );
+      }
+      t += n;
+      _tail.store( t, std::memory_order_release );
+      sent++;
+      _sent++;
+
+      const char *format = (const char *)(uintptr_t)rec[1];
+      if( _file ) {
+        fileFormat( format );
+        fwrite( rec, sizeof(uint64_t), n, _file );
+        continue;
+      }
+      sim::logRender( rec, format, text, sizeof(text) );
+      if( SIM_LOG_SINK( header ) == (uint32_t)sink::console )
+        fputs( text, stderr );
+      else
+        fputs( text, stdout );
+    }
+
+    if( sent ) {
+      if( _file )
+        fflush( _file );
+      else
+        fflush( stdout );
+    }
+    return( sent );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Drain task and log file                                                   */
+/*----------------------------------------------------------------------------*/
+
+static void
+logTask( void * ) {
+    while( true ) {
+      logger::drain();
+      sim::taskSleep( (sim::usec_t)SIM_LOG_INTERVAL * 1000 );
+    }
+}
+
+void
+sim::logStart() {
+    taskCreate( logTask, NULL, task::taskPrioritylow, NULL, "log" );
+}
+
+// NULL drains what is queued into the current file, ends it and goes
+// back to formatting
+void
+sim::logFile( FILE *fp ) {
+    if( _file ) {
+      logger::drain();
+      fileWord( 0 );
+      fileWord( 0 );
+      fileWord( _dropped.load( std::memory_order_relaxed ) );
+      fflush( _file );
+    }
+    _file        = fp;
+    _formatCount = 0;
+    if( _file )
+      fputs( SIM_LOG_MAGIC, _file );
+}
@@ -0,0 +1,268 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_motion.cpp
+//    Description:  Profiled moves, built once and fed to the motor a tick at a time
+//
+//----------------------------------------------------------------------------
+
+// The trapezoid is the usual one, accelerate, cruise, decelerate, with the
+// cruise cut short and a lower top speed when the move is too short to
+// reach it. The S-curve is that trapezoid averaged over a window of acceleration
+// / jerk seconds, which turns each step in acceleration into a ramp at the
+// jerk limit without ever going past the acceleration or velocity limits,
+// and covers the same distance. Both are worked out in closed form, X is
+// the trapezoid's position and Y the integral of it, so the table is exact
+// at every tick however coarse the tick is.
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "vex_sim.h"
+#include "vex_motion.h"
+
+using namespace vex;
+
+namespace {
+  struct trapezoid {
+    double  a;          // acceleration
+    double  v;          // top speed
+    double  ta;         // time spent accelerating, and decelerating
+    double  tc;         // time at top speed
+    double  d;          // distance
+
+    double  t2() const { return( ta + tc ); }
+    double  t3() const { return( ta + tc + ta ); }
+
+    double
+    X( double t ) const {
+      if( t <= 0 )      return( 0 );
+      if( t < ta )      return( a * t * t / 2 );
+      if( t < t2() )    return( a * ta * ta / 2 + v * (t - ta) );
+      if( t < t3() )    return( d - a * (t3() - t) * (t3() - t) / 2 );
+      return( d );
+    }
+
+    double
+    Y( double t ) const {
+      double y1 = a * ta * ta * ta / 6;
+      double y2 = y1 + a * ta * ta / 2 * tc + v * tc * tc / 2;
+      double y3 = y2 + d * ta - y1;
+      if( t <= 0 )      return( 0 );
+      if( t < ta )      return( a * t * t * t / 6 );
+      if( t < t2() )    return( y1 + a * ta * ta / 2 * (t - ta) + v * (t - ta) * (t - ta) / 2 );
+      if( t < t3() )    return( y2 + d * (t - t2()) + a * (pow( t3() - t, 3 ) - ta * ta * ta) / 6 );
+      return( y3 + d * (t - t3()) );
+    }
+  };
+
+  struct motionRun {
+    std::vector<sim::setpoint>  table;
+    size_t                      next;
+    double                      start;
+    double                      target;
+    double                      command;    // pct, for the finish in position mode
+    bool                        active;
+  };
+}
+
+static motionRun  _runs[IQ_MAX_DEVICE_PORTS];
+
+// the profile a task has armed, see motionArm
+static struct {
+    sim::tcb   *task;
+    double      velocity;
+    double      acceleration;
+    double      jerk;
+} _armed;
+
+/*----------------------------------------------------------------------------*/
+/*  Building a move                                                           */
+/*----------------------------------------------------------------------------*/
+
+void
+sim::motionBuild( std::vector<setpoint> &table, double distance, double velocity, double acceleration, double jerk ) {
+    const double dt   = SIM_POLL_INTERVAL / 1000.0;
+    double       sign = (distance < 0) ? -1 : 1;
+    trapezoid    p;
+
+    table.clear();
+    p.d = fabs( distance );
+    p.v = fabs( velocity );
+    p.a = fabs( acceleration );
+    if( p.d == 0 || p.v == 0 ) {
+      table.push_back( { distance, 0 } );
+      return;
+    }
+
+    // no acceleration limit is a step to full speed
+    if( p.a == 0 )
+      p.a = p.v / dt;
+    double tj = (jerk != 0) ? p.a / fabs( jerk ) : 0;
+
+    // the cruise has to last at least tj, or the ramps down from
+    // accelerating and into decelerating overlap and double the jerk
+    p.ta = p.v / p.a;
+    if( p.v * (p.ta + tj) > p.d ) {
+      p.v  = p.a * (sqrt( tj * tj + 4 * p.d / p.a ) - tj) / 2;
+      p.ta = p.v / p.a;
+    }
+    p.tc = (p.d - p.v * p.ta) / p.v;
+    auto position = [&]( double t ) {
+      return( tj > 0 ? (p.Y( t ) - p.Y( t - tj )) / tj : p.X( t ) );
+    };
+
+    int32_t n    = (int32_t)ceil( (p.t3() + tj) / dt - 1e-9 );
+    double  last = 0;
+    table.reserve( n );
+    for( int32_t k = 1; k <= n; k++ ) {
+      double x = (k == n) ? p.d : position( k * dt );
+      table.push_back( { sign * x, sign * (x - last) / dt } );
+      last = x;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Running moves                                                             */
+/*----------------------------------------------------------------------------*/
+
+// counts per second to the pct a velocity command takes
+static inline double
+countsToPct( double cps ) {
+    return( cps * 60.0 / SIM_MOTOR_COUNTS / SIM_MOTOR_MAX_RPM * 100.0 );
+}
+
+static void
+motionCommand( int32_t index, sim::motorMode mode, double command, double target ) {
+    sim::motorState &m = sim::portGet( index )->motor;
+    m.mode    = mode;
+    m.command = command;
+    m.target  = target;
+    if( mode == sim::motorMode::position )
+      m.flags &= ~VEXIQ_MOTOR_ZEROPOS_FLAG;
+    if( sim::trace.motorCommand )
+      sim::trace.motorCommand( index, m );
+    sim::motorSend( index );
+}
+
+void
+sim::motionStart( int32_t index, double target, double velocity, double acceleration, double jerk ) {
+    sim::port *p = portGet( index );
+    if( p == NULL )
+      return;
+
+    motionRun &r = _runs[index];
+    r.start   = p->motor.position;
+    r.target  = target;
+    r.command = std::min( countsToPct( fabs( velocity ) ), 100.0 );
+    r.next    = 0;
+    r.active  = true;
+    motionBuild( r.table, target - r.start, velocity, acceleration, jerk );
+}
+
+void
+sim::motionStop( int32_t index ) {
+    if( index >= 0 && index < IQ_MAX_DEVICE_PORTS )
+      _runs[index].active = false;
+}
+
+void
+sim::motionArm( double velocity, double acceleration, double jerk ) {
+    _armed = { taskCurrent(), velocity, acceleration, jerk };
+}
+
+void
+sim::motionDisarm() {
+    _armed.task = NULL;
+}
+
+void
+sim::motionMove( int32_t index, double target, double counts ) {
+    if( _armed.task != NULL && _armed.task == taskCurrent() )
+      motionStart( index, target, _armed.velocity * counts, _armed.acceleration * counts, _armed.jerk * counts );
+    else
+      motionStop( index );
+}
+
+bool
+sim::motionActive( int32_t index ) {
+    return( index >= 0 && index < IQ_MAX_DEVICE_PORTS && _runs[index].active );
+}
+
+void
+sim::motionStep() {
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ ) {
+      motionRun &r = _runs[i];
+      if( !r.active )
+        continue;
+
+      if( r.next >= r.table.size() ) {
+        r.active = false;
+        motionCommand( i, motorMode::position, r.command, r.target );
+        continue;
+      }
+
+      // where the last entry said the motor would be by now, and the speed
+      // the table has SIM_MOTION_LEAD on, as the motor takes that long to
+      // get to a speed it is given. Looking ahead keeps the command to the
+      // table's own acceleration and jerk, where adding on the change in
+      // speed made every step in acceleration a step in speed
+      const double    ahead    = SIM_MOTION_LEAD * 1000.0 / SIM_POLL_INTERVAL;
+      const setpoint *last     = r.next ? &r.table[r.next - 1] : NULL;
+      size_t          k        = r.next + (size_t)ahead;
+      double          frac     = ahead - floor( ahead );
+      double          v0       = k < r.table.size() ? r.table[k].velocity : 0;
+      double          v1       = k + 1 < r.table.size() ? r.table[k + 1].velocity : 0;
+      double          expected = r.start + (last ? last->position : 0);
+      double          behind   = expected - portGet( i )->motor.position;
+      double          pct      = countsToPct( v0 + (v1 - v0) * frac + behind / SIM_MOTION_CATCHUP );
+      r.next++;
+
+      // a motor that has got ahead waits for the table rather than backing
+      // up, a profiled move never turns round
+      if( r.target >= r.start )
+        pct = std::clamp( pct, 0.0, 100.0 );
+      else
+        pct = std::clamp( pct, -100.0, 0.0 );
+      motionCommand( i, motorMode::velocity, pct, r.target );
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/*  vex_motion.h                                                              */
+/*----------------------------------------------------------------------------*/
+
+// the move the motor would make anyway, at the profile's velocity, with the
+// profile armed so the motor's spinTo hands it over
+
+bool
+vex::spinTo( motor &m, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion ) {
+    sim::motionArm( profile.velocity, profile.acceleration, profile.jerk );
+    bool done = m.spinTo( rotation, units, profile.velocity, profile.units, waitForCompletion );
+    sim::motionDisarm();
+    return( done );
+}
+
+bool
+vex::spinFor( motor &m, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion ) {
+    sim::motionArm( profile.velocity, profile.acceleration, profile.jerk );
+    bool done = m.spinFor( rotation, units, profile.velocity, profile.units, waitForCompletion );
+    sim::motionDisarm();
+    return( done );
+}
+
+bool
+vex::spinTo( motor_group &g, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion ) {
+    sim::motionArm( profile.velocity, profile.acceleration, profile.jerk );
+    bool done = g.spinTo( rotation, units, profile.velocity, profile.units, waitForCompletion );
+    sim::motionDisarm();
+    return( done );
+}
+
+bool
+vex::spinFor( motor_group &g, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion ) {
+    sim::motionArm( profile.velocity, profile.acceleration, profile.jerk );
+    bool done = g.spinFor( rotation, units, profile.velocity, profile.units, waitForCompletion );
+    sim::motionDisarm();
+    return( done );
+}
@@ -0,0 +1,622 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_motor.cpp
+//    Description:  Host implementation of vex::motor
+//
+//----------------------------------------------------------------------------
+
+#include <math.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+// Raw units are what the motor firmware talks in, encoder counts for
+// position and percent of full speed for velocity. The hardware side is
+// always in the motor's own frame, reverse and the gear ratio are applied
+// here on the way in and out.
+//
+// Commands are written to the port straight away and queued for the next
+// device poll to send, readings come from the current tick's frame.
+
+static sim::motorState  _nomotor;
+
+static sim::motorState &
+hw( int32_t index ) {
+    sim::port *p = sim::portGet( index );
+    return( p ? p->motor : _nomotor );
+}
+
+// the direction a spinning motor was last sent, so a new velocity keeps
+// it going that way. It is kept by port here rather than in the motor,
+// which has to stay the size libiq makes it
+static directionType &
+spinDir( int32_t index ) {
+    static directionType  dirs[IQ_MAX_DEVICE_PORTS + 1];
+    return( dirs[(index >= 0 && index < IQ_MAX_DEVICE_PORTS) ? index : IQ_MAX_DEVICE_PORTS] );
+}
+
+static const sim::motorState &
+sensed( int32_t index ) {
+    if( index < 0 || index >= IQ_MAX_DEVICE_PORTS )
+      return( _nomotor );
+    return( sim::frameGet().ports[index].motor );
+}
+
+static inline void
+commanded( int32_t index ) {
+    if( sim::trace.motorCommand )
+      sim::trace.motorCommand( index, hw( index ) );
+    sim::motorSend( index );
+}
+
+// block until the motor reports done, or stop it after timeout mS
+static bool
+waitDone( motor &m, int32_t timeout ) {
+    uint32_t start = timer::system();
+    while( !m.isDone() ) {
+      if( timeout > 0 && (int32_t)(timer::system() - start) >= timeout ) {
+        m.stop();
+        return( false );
+      }
+      task::sleep( 10 );
+    }
+    return( true );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Construction                                                              */
+/*----------------------------------------------------------------------------*/
+
+motor::motor( int32_t index ) : motor( index, 1.0, false ) {
+}
+
+motor::motor( int32_t index, bool reverse ) : motor( index, 1.0, reverse ) {
+}
+
+motor::motor( int32_t index, double gearRatio ) : motor( index, gearRatio, false ) {
+}
+
+motor::motor( int32_t index, double gearRatio, bool reverse ) : device( index ) {
+    _timeout       = 0;
+    _velocity      = 50;
+    _last_velocity = 0;
+    _offset        = 0;
+    _bReverse      = reverse;
+    _brakeMode     = brakeType::coast;
+    _spinMode      = false;
+    _flagDelay     = 0;
+    _initDelay     = 0;
+    _gearRatio     = gearRatio > 0 ? gearRatio : 1.0;
+    sim::portInstall( index, kDeviceTypeMotorSensor );
+    sim::motorConfigure( _index, { _bReverse, _gearRatio, _flagDelay } );
+}
+
+motor::~motor() {
+}
+
+bool
+motor::installed() {
+    return( type() == kDeviceTypeMotorSensor );
+}
+
+int32_t
+motor::value() {
+    return( (int32_t)lround( sensed( _index ).position ) );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Settings                                                                  */
+/*----------------------------------------------------------------------------*/
+
+void
+motor::setReversed( bool value ) {
+    _bReverse = value;
+    sim::motorConfigure( _index, { _bReverse, _gearRatio, _flagDelay } );
+}
+
+void
+motor::setVelocity( double velocity, velocityUnits units ) {
+    _velocity = scaledToVelocity( velocity, units );
+
+    // a spinning motor picks up the new velocity straight away
+    if( _spinMode )
+      spin( spinDir( _index ) );
+}
+
+void
+motor::setBrake( brakeType mode ) {
+    defaultStopping( mode );
+}
+
+void
+motor::setStopping( brakeType mode ) {
+    defaultStopping( mode );
+}
+
+void
+motor::defaultStopping( brakeType mode ) {
+    _brakeMode = mode;
+}
+
+void
+motor::resetRotation() {
+    setPosition( 0, rotationUnits::deg );
+}
+
+void
+motor::resetPosition() {
+    setPosition( 0, rotationUnits::deg );
+}
+
+void
+motor::setRotation( double value, rotationUnits units ) {
+    setPosition( value, units );
+}
+
+void
+motor::setPosition( double value, rotationUnits units ) {
+    double raw = sensed( _index ).position * (_bReverse ? -1 : 1);
+    _offset = (int32_t)lround( raw ) - scaledToEncoder( value, units );
+}
+
+void
+motor::setTimeout( int32_t time, timeUnits units ) {
+    _timeout = (units == timeUnits::sec) ? time * 1000 : time;
+}
+
+int32_t
+motor::getTimeout() {
+    return( _timeout );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Actions                                                                   */
+/*----------------------------------------------------------------------------*/
+
+void
+motor::spin( directionType dir ) {
+    sim::motorState &m = hw( _index );
+    int32_t v = (dir == directionType::rev) ? -_velocity : _velocity;
+
+    sim::motionStop( _index );
+    _spinMode      = true;
+    _last_velocity = v;
+    spinDir( _index ) = dir;
+    m.mode         = sim::motorMode::velocity;
+    m.command      = _bReverse ? -v : v;
+    commanded( _index );
+}
+
+void
+motor::spin( directionType dir, double velocity, velocityUnits units ) {
+    _velocity = scaledToVelocity( velocity, units );
+    spin( dir );
+}
+
+void
+motor::spin( directionType dir, double voltage, voltageUnits units ) {
+    sim::motorState &m = hw( _index );
+    double v = (units == voltageUnits::mV) ? voltage / 1000.0 : voltage;
+    if( dir == directionType::rev )
+      v = -v;
+
+    sim::motionStop( _index );
+    _spinMode = false;
+    m.mode    = sim::motorMode::voltage;
+    m.command = _bReverse ? -v : v;
+    commanded( _index );
+}
+
+bool
+motor::rotateTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinTo( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::spinTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    sim::motorState &m = hw( _index );
+    double target = scaledToEncoder( rotation, units ) + _offset;
+
+    // a profile armed by vex_motion.h takes the move over, its limits are
+    // in units_v, which this many counts a second are one of
+    _spinMode = false;
+    m.target  = _bReverse ? -target : target;
+    sim::motionMove( _index, m.target, SIM_MOTOR_MAX_RPM * SIM_MOTOR_COUNTS / 60.0 / velocityToScaled( 100, units_v ) );
+    m.command = abs( scaledToVelocity( velocity, units_v ) );
+    m.mode    = sim::motorMode::position;
+    m.flags  &= ~VEXIQ_MOTOR_ZEROPOS_FLAG;
+    commanded( _index );
+
+    // frames up to this one were read before the move started
+    _flagDelay = sim::frameGet().tick;
+    sim::motorConfigure( _index, { _bReverse, _gearRatio, _flagDelay } );
+
+    if( !waitForCompletion )
+      return( true );
+    return( waitDone( *this, _timeout ) );
+}
+
+bool
+motor::spinToPosition( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinTo( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::rotateTo( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinTo( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor::spinTo( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinTo( rotation, units, _velocity, velocityUnits::pct, waitForCompletion ) );
+}
+
+bool
+motor::spinToPosition( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinTo( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor::rotateFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinFor( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::spinFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinTo( position( units ) + rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::rotateFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinFor( dir, rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::spinFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    if( dir == directionType::rev )
+      rotation = -rotation;
+    return( spinFor( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor::rotateFor( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor::spinFor( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( rotation, units, _velocity, velocityUnits::pct, waitForCompletion ) );
+}
+
+bool
+motor::rotateFor( directionType dir, double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( dir, rotation, units, waitForCompletion ) );
+}
+
+bool
+motor::spinFor( directionType dir, double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( dir, rotation, units, _velocity, velocityUnits::pct, waitForCompletion ) );
+}
+
+bool
+motor::rotateFor( double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    return( spinFor( time, units, velocity, units_v ) );
+}
+
+bool
+motor::spinFor( double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    return( spinFor( directionType::fwd, time, units, velocity, units_v ) );
+}
+
+bool
+motor::rotateFor( directionType dir, double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    return( spinFor( dir, time, units, velocity, units_v ) );
+}
+
+bool
+motor::spinFor( directionType dir, double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    if( time < 0 )
+      return( false );
+    spin( dir, velocity, units_v );
+    wait( time, units );
+    stop();
+    return( true );
+}
+
+bool
+motor::rotateFor( double time, timeUnits units ) {
+    return( spinFor( time, units ) );
+}
+
+bool
+motor::spinFor( double time, timeUnits units ) {
+    return( spinFor( directionType::fwd, time, units, _velocity, velocityUnits::pct ) );
+}
+
+bool
+motor::rotateFor( directionType dir, double time, timeUnits units ) {
+    return( spinFor( dir, time, units ) );
+}
+
+bool
+motor::spinFor( directionType dir, double time, timeUnits units ) {
+    return( spinFor( dir, time, units, _velocity, velocityUnits::pct ) );
+}
+
+void
+motor::startRotateTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinTo( rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startSpinTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinTo( rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startRotateTo( double rotation, rotationUnits units ) {
+    spinTo( rotation, units, false );
+}
+
+void
+motor::startSpinTo( double rotation, rotationUnits units ) {
+    spinTo( rotation, units, false );
+}
+
+void
+motor::startRotateFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startSpinFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startRotateFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( dir, rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startSpinFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( dir, rotation, units, velocity, units_v, false );
+}
+
+void
+motor::startRotateFor( double rotation, rotationUnits units ) {
+    spinFor( rotation, units, false );
+}
+
+void
+motor::startSpinFor( double rotation, rotationUnits units ) {
+    spinFor( rotation, units, false );
+}
+
+void
+motor::startRotateFor( directionType dir, double rotation, rotationUnits units ) {
+    spinFor( dir, rotation, units, false );
+}
+
+void
+motor::startSpinFor( directionType dir, double rotation, rotationUnits units ) {
+    spinFor( dir, rotation, units, false );
+}
+
+bool
+motor::isSpinning() {
+    sim::motorState &m = hw( _index );
+    switch( m.mode ) {
+      case sim::motorMode::position:
+        return( !isDone() );
+      case sim::motorMode::velocity:
+      case sim::motorMode::voltage:
+        return( m.command != 0 );
+      default:
+        return( false );
+    }
+}
+
+bool
+motor::isDone() {
+    if( sim::motionActive( _index ) )
+      return( false );
+    return( modeGet() != (uint8_t)sim::motorMode::position || zeroPositionFlag() );
+}
+
+bool
+motor::isSpinningMode() {
+    return( _spinMode );
+}
+
+void
+motor::stop() {
+    stop( _brakeMode );
+}
+
+void
+motor::stop( brakeType mode ) {
+    sim::motorState &m = hw( _index );
+
+    sim::motionStop( _index );
+    _spinMode = false;
+    m.command = 0;
+    switch( mode ) {
+      case brakeType::brake:
+        m.mode = sim::motorMode::brake;
+        break;
+      case brakeType::hold:
+        m.mode   = sim::motorMode::hold;
+        m.target = m.position;
+        break;
+      default:
+        m.mode = sim::motorMode::coast;
+        break;
+    }
+    commanded( _index );
+}
+
+void
+motor::setMaxTorque( double value, percentUnits units ) {
+    if( value < 0 )   value = 0;
+    if( value > 100 ) value = 100;
+    hw( _index ).maxTorque = value;
+    commanded( _index );
+}
+
+void
+motor::setMaxTorque( double value, torqueUnits units ) {
+    if( units == torqueUnits::InLb )
+      value /= 8.851;
+    setMaxTorque( value / SIM_MOTOR_STALL_NM * 100.0, percentUnits::pct );
+}
+
+void
+motor::setMaxTorque( double value, currentUnits units ) {
+    setMaxTorque( value / SIM_MOTOR_MAX_AMPS * 100.0, percentUnits::pct );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Sensing                                                                   */
+/*----------------------------------------------------------------------------*/
+
+directionType
+motor::direction() {
+    double v = sensed( _index ).velocity * (_bReverse ? -1 : 1);
+    return( v < 0 ? directionType::rev : directionType::fwd );
+}
+
+double
+motor::rotation( rotationUnits units ) {
+    return( position( units ) );
+}
+
+double
+motor::position( rotationUnits units ) {
+    double raw = sensed( _index ).position * (_bReverse ? -1 : 1);
+    return( encoderToScaled( (int32_t)lround( raw ) - _offset, units ) );
+}
+
+double
+motor::velocity( velocityUnits units ) {
+    double rpm = sensed( _index ).velocity * (_bReverse ? -1 : 1) / _gearRatio;
+    switch( units ) {
+      case velocityUnits::rpm: return( rpm );
+      case velocityUnits::dps: return( rpm * 6.0 );
+      default:                 return( rpm * _gearRatio * 100.0 / SIM_MOTOR_MAX_RPM );
+    }
+}
+
+double
+motor::current( currentUnits units ) {
+    return( sensed( _index ).current );
+}
+
+double
+motor::current( percentUnits units ) {
+    return( sensed( _index ).current / SIM_MOTOR_MAX_AMPS * 100.0 );
+}
+
+double
+motor::voltage( voltageUnits units ) {
+    double v = sensed( _index ).voltage * (_bReverse ? -1 : 1);
+    return( units == voltageUnits::mV ? v * 1000 : v );
+}
+
+double
+motor::power( powerUnits units ) {
+    return( fabs( voltage() * current() ) );
+}
+
+double
+motor::torque( torqueUnits units ) {
+    double nm = sensed( _index ).current / SIM_MOTOR_MAX_AMPS * SIM_MOTOR_STALL_NM;
+    return( units == torqueUnits::InLb ? nm * 8.851 : nm );
+}
+
+double
+motor::efficiency( percentUnits units ) {
+    double in = power();
+    if( in <= 0 )
+      return( 0 );
+    double out = torque() * fabs( sensed( _index ).velocity ) * 2 * M_PI / 60.0;
+    return( out / in * 100.0 );
+}
+
+double
+motor::temperature( percentUnits units ) {
+    // 0% at ambient, 100% at the overtemp cutout
+    double c = sensed( _index ).temperature;
+    return( (c - SIM_MOTOR_AMBIENT) / (SIM_MOTOR_HOT - SIM_MOTOR_AMBIENT) * 100.0 );
+}
+
+double
+motor::temperature( temperatureUnits units ) {
+    double c = sensed( _index ).temperature;
+    return( units == temperatureUnits::fahrenheit ? c * 9.0 / 5.0 + 32.0 : c );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Private helpers                                                           */
+/*----------------------------------------------------------------------------*/
+
+bool
+motor::zeroPositionFlag() {
+    const sim::frame &f = sim::frameGet();
+    if( _index < 0 || _index >= IQ_MAX_DEVICE_PORTS || f.tick <= (uint32_t)_flagDelay )
+      return( false );
+    return( (f.ports[_index].motor.flags & VEXIQ_MOTOR_ZEROPOS_FLAG) != 0 );
+}
+
+uint8_t
+motor::modeGet() {
+    return( (uint8_t)hw( _index ).mode );
+}
+
+double
+motor::velocityToScaled( int32_t velocity, velocityUnits units ) {
+    double rpm = velocity * SIM_MOTOR_MAX_RPM / 100.0 / _gearRatio;
+    switch( units ) {
+      case velocityUnits::rpm: return( rpm );
+      case velocityUnits::dps: return( rpm * 6.0 );
+      default:                 return( velocity );
+    }
+}
+
+int32_t
+motor::scaledToVelocity( double value, velocityUnits units ) {
+    double pct;
+    switch( units ) {
+      case velocityUnits::rpm: pct = value * _gearRatio * 100.0 / SIM_MOTOR_MAX_RPM; break;
+      case velocityUnits::dps: pct = value / 6.0 * _gearRatio * 100.0 / SIM_MOTOR_MAX_RPM; break;
+      default:                 pct = value; break;
+    }
+    if( pct >  100 ) pct =  100;
+    if( pct < -100 ) pct = -100;
+    return( (int32_t)lround( pct ) );
+}
+
+double
+motor::encoderToScaled( int32_t counts, rotationUnits units ) {
+    switch( units ) {
+      case rotationUnits::deg: return( counts * 360.0 / SIM_MOTOR_COUNTS / _gearRatio );
+      case rotationUnits::rev: return( counts / (double)SIM_MOTOR_COUNTS / _gearRatio );
+      default:                 return( counts );
+    }
+}
+
+int32_t
+motor::scaledToEncoder( double position, rotationUnits units ) {
+    switch( units ) {
+      case rotationUnits::deg: return( (int32_t)lround( position * _gearRatio * SIM_MOTOR_COUNTS / 360.0 ) );
+      case rotationUnits::rev: return( (int32_t)lround( position * _gearRatio * SIM_MOTOR_COUNTS ) );
+      default:                 return( (int32_t)lround( position ) );
+    }
+}
+
+double
+motor::torqueToCurrent( double torque ) {
+    return( torque / SIM_MOTOR_STALL_NM * SIM_MOTOR_MAX_AMPS );
+}
+
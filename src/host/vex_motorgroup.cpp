@@ -0,0 +1,565 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_motorgroup.cpp
+//    Description:  Host implementation of vex::motor_group
+//
+//----------------------------------------------------------------------------
+
+// A group keeps pointers to motors the program owns in a list held on the
+// host, out of the _memory libiq sets aside in the group, so motor_group
+// keeps libiq's layout. Each entry has the motor's port and a copy of its
+// sim::motorConfig, the reverse, gear ratio and flag delay, which the
+// motor refreshes whenever it changes them. The group passes each call
+// on to every one of its motors. Moves that wait are started on all the
+// motors first and then waited for together, readings are taken from the
+// first motor apart from current, which is the total as the header says.
+// current, isDone and the aggregates read every port from one frame in a
+// single pass down the list, without going through the motors at all.
+//
+// Every call a member motor makes is its own command on the bus. With
+// batching on the members' ports are held, so only the last command each
+// one was given goes out, and they go in one transaction when commit is
+// called or at the next device poll, whichever comes first.
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+namespace {
+  struct member {
+    motor              *m;
+    int32_t             port;
+    sim::motorConfig    config;
+  };
+
+  // what a group holds, outside the group's private impl so the helpers
+  // here can take it
+  struct memberList {
+    member              members[SIM_GROUP_MOTORS];
+    int32_t             count;
+    bool                batching;
+    memberList         *next;       // every group, for motorConfigure
+  };
+}
+
+class motor_group::motor_group_impl : public memberList {
+};
+
+static memberList        *_groups;
+static sim::motorConfig   _configs[IQ_MAX_DEVICE_PORTS];
+
+// run f on every motor in the group
+template <typename F>
+static inline void
+each( memberList *g, F f ) {
+    for( int32_t i = 0; i < g->count; i++ )
+      f( *g->members[i].m );
+}
+
+void
+sim::motorConfigure( int32_t index, const motorConfig &c ) {
+    if( index < 0 || index >= IQ_MAX_DEVICE_PORTS )
+      return;
+    _configs[index] = c;
+    for( memberList *g = _groups; g != NULL; g = g->next )
+      for( int32_t i = 0; i < g->count; i++ )
+        if( g->members[i].port == index )
+          g->members[i].config = c;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Construction                                                              */
+/*----------------------------------------------------------------------------*/
+
+motor_group::motor_group_motors::motor_group_motors() {
+    pimpl = new motor_group_impl();
+    pimpl->next = _groups;
+    _groups     = pimpl;
+}
+
+motor_group::motor_group_motors::motor_group_motors( const motor_group_motors &other ) {
+    pimpl       = new motor_group_impl( *other.pimpl );
+    pimpl->next = _groups;
+    _groups     = pimpl;
+}
+
+motor_group::motor_group_motors::~motor_group_motors() {
+    for( memberList **g = &_groups; *g != NULL; g = &(*g)->next ) {
+      if( *g == pimpl ) {
+        *g = pimpl->next;
+        break;
+      }
+    }
+    delete pimpl;
+}
+
+motor_group::motor_group() {
+    _timeout = 0;
+}
+
+motor_group::~motor_group() {
+}
+
+void
+motor_group::_addMotor() {
+}
+
+void
+motor_group::_addMotor( motor &m ) {
+    memberList *g = _motors.pimpl;
+    if( g->count >= SIM_GROUP_MOTORS ) {
+      fprintf( stderr, "motor_group: more than %d motors, port %d not added\n", SIM_GROUP_MOTORS, m.index() + 1 );
+      return;
+    }
+    member &e = g->members[g->count++];
+    e.m      = &m;
+    e.port   = m.index();
+    e.config = (e.port >= 0 && e.port < IQ_MAX_DEVICE_PORTS) ? _configs[e.port] : sim::motorConfig{ false, 1, 0 };
+    if( g->batching )
+      sim::motorHold( e.port, true );
+}
+
+motor *
+motor_group::_motor( int32_t i ) {
+    return( _motors.pimpl->members[i].m );
+}
+
+int32_t
+motor_group::count() {
+    return( _motors.pimpl->count );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Batching                                                                  */
+/*----------------------------------------------------------------------------*/
+
+void
+motor_group::setBatching( bool value ) {
+    _motors.pimpl->batching = value;
+    each( _motors.pimpl, [=]( motor &m ) { sim::motorHold( m.index(), value ); } );
+}
+
+void
+motor_group::commit() {
+    const memberList *g = _motors.pimpl;
+    int32_t ports[SIM_GROUP_MOTORS];
+    for( int32_t i = 0; i < g->count; i++ )
+      ports[i] = g->members[i].port;
+    sim::motorCommit( ports, g->count );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Settings                                                                  */
+/*----------------------------------------------------------------------------*/
+
+void
+motor_group::setVelocity( double velocity, velocityUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setVelocity( velocity, units ); } );
+}
+
+void
+motor_group::setStopping( brakeType mode ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setStopping( mode ); } );
+}
+
+void
+motor_group::resetRotation() {
+    each( _motors.pimpl, []( motor &m ) { m.resetRotation(); } );
+}
+
+void
+motor_group::resetPosition() {
+    resetRotation();
+}
+
+void
+motor_group::setRotation( double value, rotationUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setRotation( value, units ); } );
+}
+
+void
+motor_group::setPosition( double value, rotationUnits units ) {
+    setRotation( value, units );
+}
+
+void
+motor_group::setTimeout( int32_t time, timeUnits units ) {
+    _timeout = (units == timeUnits::sec) ? time * 1000 : time;
+}
+
+void
+motor_group::setMaxTorque( double value, percentUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setMaxTorque( value, units ); } );
+}
+
+void
+motor_group::setMaxTorque( double value, torqueUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setMaxTorque( value, units ); } );
+}
+
+void
+motor_group::setMaxTorque( double value, currentUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.setMaxTorque( value, units ); } );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Actions                                                                   */
+/*----------------------------------------------------------------------------*/
+
+void
+motor_group::spin( directionType dir ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spin( dir ); } );
+}
+
+void
+motor_group::spin( directionType dir, double velocity, velocityUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spin( dir, velocity, units ); } );
+}
+
+void
+motor_group::spin( directionType dir, double voltage, voltageUnits units ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spin( dir, voltage, units ); } );
+}
+
+// block until every motor reports done, or stop them all after the timeout
+bool
+motor_group::waitForCompletionAll() {
+    // the moves were only queued if batching, send them before waiting
+    commit();
+
+    uint32_t start = timer::system();
+    while( !isDone() ) {
+      if( _timeout > 0 && (int32_t)(timer::system() - start) >= _timeout ) {
+        stop();
+        return( false );
+      }
+      task::sleep( 10 );
+    }
+    return( true );
+}
+
+bool
+motor_group::rotateTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinTo( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor_group::spinTo( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spinTo( rotation, units, velocity, units_v, false ); } );
+    if( !waitForCompletion )
+      return( true );
+    return( waitForCompletionAll() );
+}
+
+bool
+motor_group::spinToPosition( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinTo( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor_group::rotateTo( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinTo( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor_group::spinTo( double rotation, rotationUnits units, bool waitForCompletion ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spinTo( rotation, units, false ); } );
+    if( !waitForCompletion )
+      return( true );
+    return( waitForCompletionAll() );
+}
+
+bool
+motor_group::spinToPosition( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinTo( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor_group::rotateFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinFor( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor_group::spinFor( double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spinFor( rotation, units, velocity, units_v, false ); } );
+    if( !waitForCompletion )
+      return( true );
+    return( waitForCompletionAll() );
+}
+
+bool
+motor_group::rotateFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    return( spinFor( dir, rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor_group::spinFor( directionType dir, double rotation, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion ) {
+    if( dir == directionType::rev )
+      rotation = -rotation;
+    return( spinFor( rotation, units, velocity, units_v, waitForCompletion ) );
+}
+
+bool
+motor_group::rotateFor( double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( rotation, units, waitForCompletion ) );
+}
+
+bool
+motor_group::spinFor( double rotation, rotationUnits units, bool waitForCompletion ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.spinFor( rotation, units, false ); } );
+    if( !waitForCompletion )
+      return( true );
+    return( waitForCompletionAll() );
+}
+
+bool
+motor_group::rotateFor( directionType dir, double rotation, rotationUnits units, bool waitForCompletion ) {
+    return( spinFor( dir, rotation, units, waitForCompletion ) );
+}
+
+bool
+motor_group::spinFor( directionType dir, double rotation, rotationUnits units, bool waitForCompletion ) {
+    if( dir == directionType::rev )
+      rotation = -rotation;
+    return( spinFor( rotation, units, waitForCompletion ) );
+}
+
+void
+motor_group::rotateFor( double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( directionType::fwd, time, units, velocity, units_v );
+}
+
+void
+motor_group::spinFor( double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( directionType::fwd, time, units, velocity, units_v );
+}
+
+void
+motor_group::rotateFor( directionType dir, double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    spinFor( dir, time, units, velocity, units_v );
+}
+
+void
+motor_group::spinFor( directionType dir, double time, timeUnits units, double velocity, velocityUnits units_v ) {
+    if( time < 0 )
+      return;
+    spin( dir, velocity, units_v );
+    commit();
+    wait( time, units );
+    stop();
+}
+
+void
+motor_group::rotateFor( double time, timeUnits units ) {
+    spinFor( directionType::fwd, time, units );
+}
+
+void
+motor_group::spinFor( double time, timeUnits units ) {
+    spinFor( directionType::fwd, time, units );
+}
+
+void
+motor_group::rotateFor( directionType dir, double time, timeUnits units ) {
+    spinFor( dir, time, units );
+}
+
+void
+motor_group::spinFor( directionType dir, double time, timeUnits units ) {
+    if( time < 0 )
+      return;
+    spin( dir );
+    commit();
+    wait( time, units );
+    stop();
+}
+
+bool
+motor_group::isSpinning() {
+    const memberList *g = _motors.pimpl;
+    for( int32_t i = 0; i < g->count; i++ )
+      if( g->members[i].m->isSpinning() )
+        return( true );
+    return( false );
+}
+
+// motor::isDone, from the group's copy of the motor's flag delay
+static bool
+done( const member &e, const sim::frame &f ) {
+    if( sim::motionActive( e.port ) )
+      return( false );
+    if( sim::portGet( e.port )->motor.mode != sim::motorMode::position )
+      return( true );
+    return( f.tick > (uint32_t)e.config.flagDelay && (f.ports[e.port].motor.flags & VEXIQ_MOTOR_ZEROPOS_FLAG) != 0 );
+}
+
+bool
+motor_group::isDone() {
+    const memberList *g = _motors.pimpl;
+    const sim::frame &f = sim::frameGet();
+    for( int32_t i = 0; i < g->count; i++ )
+      if( !done( g->members[i], f ) )
+        return( false );
+    return( true );
+}
+
+bool
+motor_group::isSpinningMode() {
+    const memberList *g = _motors.pimpl;
+    return( g->count > 0 && g->members[0].m->isSpinningMode() );
+}
+
+void
+motor_group::stop() {
+    each( _motors.pimpl, []( motor &m ) { m.stop(); } );
+}
+
+void
+motor_group::stop( brakeType mode ) {
+    each( _motors.pimpl, [=]( motor &m ) { m.stop( mode ); } );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Sensing                                                                   */
+/*----------------------------------------------------------------------------*/
+
+// readings of an empty group are all zero
+#define FIRST( call )   (_motors.pimpl->count ? _motors.pimpl->members[0].m->call : 0)
+
+directionType
+motor_group::direction() {
+    return( _motors.pimpl->count ? _motors.pimpl->members[0].m->direction() : directionType::fwd );
+}
+
+double
+motor_group::rotation( rotationUnits units ) {
+    return( FIRST( rotation( units ) ) );
+}
+
+double
+motor_group::position( rotationUnits units ) {
+    return( FIRST( position( units ) ) );
+}
+
+double
+motor_group::velocity( velocityUnits units ) {
+    return( FIRST( velocity( units ) ) );
+}
+
+double
+motor_group::current( currentUnits units ) {
+    const memberList *g = _motors.pimpl;
+    const sim::frame &f = sim::frameGet();
+    double total = 0;
+    for( int32_t i = 0; i < g->count; i++ )
+      total += f.ports[g->members[i].port].motor.current;
+    return( total );
+}
+
+double
+motor_group::current( percentUnits units ) {
+    int32_t n = _motors.pimpl->count;
+    if( n == 0 )
+      return( 0 );
+    return( current() / n / SIM_MOTOR_MAX_AMPS * 100.0 );
+}
+
+double
+motor_group::voltage( voltageUnits units ) {
+    return( FIRST( voltage( units ) ) );
+}
+
+double
+motor_group::power( powerUnits units ) {
+    return( FIRST( power( units ) ) );
+}
+
+double
+motor_group::torque( torqueUnits units ) {
+    return( FIRST( torque( units ) ) );
+}
+
+double
+motor_group::efficiency( percentUnits units ) {
+    return( FIRST( efficiency( units ) ) );
+}
+
+double
+motor_group::temperature( percentUnits units ) {
+    return( FIRST( temperature( units ) ) );
+}
+
+double
+motor_group::temperature( temperatureUnits units ) {
+    return( FIRST( temperature( units ) ) );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Aggregates, one pass over the members and the ports they read             */
+/*----------------------------------------------------------------------------*/
+
+motor_group::readings
+motor_group::aggregate( velocityUnits units_v, temperatureUnits units_t ) {
+    const memberList *g = _motors.pimpl;
+    const sim::frame &f = sim::frameGet();
+    readings r   = { 0, 0, 0, true };
+    double   rpm = 0;     // at the output
+    double   raw = 0;     // at the motor, for pct
+    double   hot = -273;
+
+    for( int32_t i = 0; i < g->count; i++ ) {
+      const member          &e = g->members[i];
+      const sim::motorState &s = f.ports[e.port].motor;
+      double v = e.config.reverse ? -s.velocity : s.velocity;
+      raw += v;
+      rpm += v / e.config.gearRatio;
+      r.current += s.current;
+      hot = s.temperature > hot ? s.temperature : hot;
+      r.done = r.done && done( e, f );
+    }
+    if( g->count == 0 )
+      return( r );
+
+    switch( units_v ) {
+      case velocityUnits::rpm: r.velocity = rpm / g->count; break;
+      case velocityUnits::dps: r.velocity = rpm * 6.0 / g->count; break;
+      default:                 r.velocity = raw * 100.0 / SIM_MOTOR_MAX_RPM / g->count; break;
+    }
+    r.temperature = units_t == temperatureUnits::fahrenheit ? hot * 9.0 / 5.0 + 32.0 : hot;
+    return( r );
+}
+
+double
+motor_group::averageVelocity( velocityUnits units ) {
+    const memberList *g = _motors.pimpl;
+    const sim::frame &f = sim::frameGet();
+    double rpm = 0, raw = 0;
+    for( int32_t i = 0; i < g->count; i++ ) {
+      const member &e = g->members[i];
+      double v = f.ports[e.port].motor.velocity;
+      v    = e.config.reverse ? -v : v;
+      raw += v;
+      rpm += v / e.config.gearRatio;
+    }
+    if( g->count == 0 )
+      return( 0 );
+    switch( units ) {
+      case velocityUnits::rpm: return( rpm / g->count );
+      case velocityUnits::dps: return( rpm * 6.0 / g->count );
+      default:                 return( raw * 100.0 / SIM_MOTOR_MAX_RPM / g->count );
+    }
+}
+
+double
+motor_group::maxTemperature( temperatureUnits units ) {
+    const memberList *g = _motors.pimpl;
+    const sim::frame &f = sim::frameGet();
+    if( g->count == 0 )
+      return( 0 );
+    double hot = -273;
+    for( int32_t i = 0; i < g->count; i++ ) {
+      double c = f.ports[g->members[i].port].motor.temperature;
+      hot = c > hot ? c : hot;
+    }
+    return( units == temperatureUnits::fahrenheit ? hot * 9.0 / 5.0 + 32.0 : hot );
+}
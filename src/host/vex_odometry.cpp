@@ -0,0 +1,194 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_odometry.cpp
+//    Description:  Host implementation of vex::odometry
+//
+//----------------------------------------------------------------------------
+
+// The tick is a kernel task of its own at taskPriorityHigh, so it runs
+// ahead of the program's tasks when it is due and reads the same frame
+// they do. It keeps the pose in doubles and only the snapshot it publishes
+// is float, mm in a float is good to well under a mm across any field.
+//
+// The sides give their distance as the mean of the two wheels, the turn
+// between ticks is dtheta, and the robot is moved along the chord of the
+// arc, length d * sin(dtheta/2) / (dtheta/2), at the mean of the headings
+// either end. With the gyro, dtheta is the change in its rotation, which is
+// read unwrapped so a tick across 180 degrees is not a whole turn.
+
+#include <math.h>
+
+#include "vex_sim.h"
+#include "vex_odometry.h"
+
+using namespace vex;
+
+static double
+toMm( double distance, distanceUnits units ) {
+    switch( units ) {
+      case distanceUnits::in: return( distance * 25.4 );
+      case distanceUnits::cm: return( distance * 10 );
+      default:                return( distance );
+    }
+}
+
+static double
+fromMm( double mm, distanceUnits units ) {
+    switch( units ) {
+      case distanceUnits::in: return( mm / 25.4 );
+      case distanceUnits::cm: return( mm / 10 );
+      default:                return( mm );
+    }
+}
+
+// rad counterclockwise, whichever way the gyro counts
+static double
+gyroRad( gyro &g ) {
+    double deg = g.rotation( rotationUnits::deg );
+    return( (g.getTurnType() == turnType::right ? -deg : deg) * M_PI / 180.0 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Construction                                                              */
+/*----------------------------------------------------------------------------*/
+
+odometry::odometry( motor_group &l, motor_group &r, double wheelTravel, double trackWidth, distanceUnits unit, double externalGearRatio ) {
+    _init( l, r, NULL, wheelTravel, trackWidth, unit, externalGearRatio );
+}
+
+odometry::odometry( motor_group &l, motor_group &r, vex::gyro &g, double wheelTravel, double trackWidth, distanceUnits unit, double externalGearRatio ) {
+    _init( l, r, &g, wheelTravel, trackWidth, unit, externalGearRatio );
+}
+
+odometry::~odometry() {
+    stop();
+}
+
+void
+odometry::_init( motor_group &l, motor_group &r, vex::gyro *g, double wheelTravel, double trackWidth, distanceUnits unit, double externalGearRatio ) {
+    _left      = &l;
+    _right     = &r;
+    _gyro      = g;
+    _travel    = toMm( wheelTravel, unit ) / (externalGearRatio > 0 ? externalGearRatio : 1.0);
+    _track     = toMm( trackWidth, unit );
+    _x         = 0;
+    _y         = 0;
+    _theta     = 0;
+    _lastLeft  = 0;
+    _lastRight = 0;
+    _lastGyro  = 0;
+    _primed    = false;
+    _interval  = 10;
+    _reset     = pose();
+    _resetPending.store( false );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  The tick                                                                  */
+/*----------------------------------------------------------------------------*/
+
+void
+odometry::_step() {
+    double left  = _left->position( rotationUnits::rev ) * _travel;
+    double right = _right->position( rotationUnits::rev ) * _travel;
+    double turn  = _gyro ? gyroRad( *_gyro ) : 0;
+
+    if( _resetPending.exchange( false, std::memory_order_acquire ) ) {
+      _x     = _reset.x;
+      _y     = _reset.y;
+      _theta = _reset.heading * M_PI / 180.0;
+    }
+    else
+    if( _primed ) {
+      double dl     = left - _lastLeft;
+      double dr     = right - _lastRight;
+      double dtheta = _gyro ? turn - _lastGyro : (dr - dl) / _track;
+      double d      = (dl + dr) / 2;
+      double half   = dtheta / 2;
+      double chord  = fabs( half ) < 1e-9 ? d : d * sin( half ) / half;
+      _x     += chord * cos( _theta + half );
+      _y     += chord * sin( _theta + half );
+      _theta += dtheta;
+    }
+    _lastLeft  = left;
+    _lastRight = right;
+    _lastGyro  = turn;
+    _primed    = true;
+
+    pose p;
+    p.x       = (float)_x;
+    p.y       = (float)_y;
+    p.heading = (float)(remainder( _theta, 2 * M_PI ) * 180.0 / M_PI);
+    p.time    = timer::system();
+    _pose.store( p );
+}
+
+void
+odometry::_run( void *arg ) {
+    odometry   *o   = (odometry *)arg;
+    sim::usec_t due = sim::now();
+    for( ;; ) {
+      o->_step();
+      due += (sim::usec_t)o->_interval * 1000;
+      sim::taskSleepUntil( due );
+    }
+}
+
+void
+odometry::start( uint32_t interval ) {
+    stop();
+    _interval = interval ? interval : 1;
+    _primed   = false;
+    sim::taskCreate( _run, this, task::taskPriorityHigh, this, "odometry" );
+}
+
+// the task is tagged with the odometry, so it goes with the program's
+// tasks when the program stops and is found again here
+void
+odometry::stop() {
+    sim::tcb *t = sim::taskFind( this );
+    if( t != NULL )
+      sim::taskDelete( t );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Reading and setting the pose                                              */
+/*----------------------------------------------------------------------------*/
+
+// with the tick running only it writes the pose, stopped there is nothing
+// else writing so it goes straight to the snapshot
+void
+odometry::setPose( double x, double y, double heading, distanceUnits units_d, rotationUnits units_r ) {
+    pose p;
+    p.x       = (float)toMm( x, units_d );
+    p.y       = (float)toMm( y, units_d );
+    p.heading = (float)(units_r == rotationUnits::rev ? heading * 360.0 : heading);
+    p.time    = timer::system();
+
+    if( sim::taskFind( this ) != NULL ) {
+      _reset = p;
+      _resetPending.store( true, std::memory_order_release );
+      return;
+    }
+    _x      = p.x;
+    _y      = p.y;
+    _theta  = p.heading * M_PI / 180.0;
+    _primed = false;
+    _pose.store( p );
+}
+
+double
+odometry::x( distanceUnits units ) const {
+    return( fromMm( get().x, units ) );
+}
+
+double
+odometry::y( distanceUnits units ) const {
+    return( fromMm( get().y, units ) );
+}
+
+double
+odometry::heading( rotationUnits units ) const {
+    double deg = get().heading;
+    return( units == rotationUnits::rev ? deg / 360.0 : deg );
+}
@@ -0,0 +1,507 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_sim.cpp
+//    Description:  Simulated ports, device poll and input scripts
+//
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+sim::traceHooks               sim::trace;
+
+static sim::port              _ports[IQ_MAX_DEVICE_PORTS];
+static sim::controllerState   _controller;
+static sim::brainState        _brain = { 0, 100, 7.2 };
+static sim::frame             _frame;
+
+// the command each motor was last sent, which is what it runs on
+static sim::motorState        _sent[IQ_MAX_DEVICE_PORTS];
+
+// commands waiting for the next poll, by port, and held ports
+static int8_t                 _sends[SIM_MOTOR_SENDS];
+static bool                   _joined[SIM_MOTOR_SENDS];
+static int32_t                _sendCount;
+static bool                   _held[IQ_MAX_DEVICE_PORTS];
+static bool                   _pending[IQ_MAX_DEVICE_PORTS];
+static sim::busStats          _bus;
+
+/*----------------------------------------------------------------------------*/
+/*  Hardware state                                                            */
+/*----------------------------------------------------------------------------*/
+
+sim::port *
+sim::portGet( int32_t index ) {
+    if( index < 0 || index >= IQ_MAX_DEVICE_PORTS )
+      return( NULL );
+    return( &_ports[index] );
+}
+
+void
+sim::portInstall( int32_t index, IQ_DeviceType type ) {
+    port *p = portGet( index );
+    if( p == NULL )
+      return;
+
+    memset( p, 0, sizeof(port) );
+    p->type                  = type;
+    p->motor.maxTorque       = 100;
+    p->motor.temperature     = SIM_MOTOR_AMBIENT;
+    p->sonar.distance        = 1000;
+
+    // a device installed mid tick is readable straight away
+    _frame.ports[index] = *p;
+    _sent[index]        = p->motor;
+    _held[index]        = false;
+    _pending[index]     = false;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Motor command bus                                                         */
+/*----------------------------------------------------------------------------*/
+
+// a port joined to the send before it goes in the same transaction
+static void
+queueSend( int32_t index, bool joined ) {
+    // a full queue still gets the latest command out, it is read at send time
+    if( _sendCount < SIM_MOTOR_SENDS ) {
+      _joined[_sendCount] = joined && _sendCount > 0;
+      _sends[_sendCount++] = index;
+    }
+    else
+    if( std::find( _sends, _sends + _sendCount, index ) == _sends + _sendCount )
+      _sends[_sendCount - 1] = index;
+}
+
+void
+sim::motorSend( int32_t index ) {
+    if( index < 0 || index >= IQ_MAX_DEVICE_PORTS )
+      return;
+    if( _held[index] )
+      _pending[index] = true;
+    else
+      queueSend( index, false );
+}
+
+void
+sim::motorHold( int32_t index, bool held ) {
+    if( index < 0 || index >= IQ_MAX_DEVICE_PORTS )
+      return;
+    if( !held )
+      motorCommit( &index, 1 );
+    _held[index] = held;
+}
+
+void
+sim::motorCommit( const int32_t *index, int32_t count ) {
+    bool joined = false;
+    for( int32_t k = 0; k < count; k++ ) {
+      int32_t i = index[k];
+      if( i < 0 || i >= IQ_MAX_DEVICE_PORTS || !_pending[i] )
+        continue;
+      _pending[i] = false;
+      queueSend( i, joined );
+      joined = true;
+    }
+}
+
+const sim::busStats &
+sim::busStatsGet() {
+    return( _bus );
+}
+
+// commit whatever is still held as one transaction, send what is queued,
+// and note when in the tick each port's last command lands
+static void
+motorSendAll( sim::usec_t landed[] ) {
+    int32_t ports[IQ_MAX_DEVICE_PORTS];
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ ) {
+      ports[i]  = i;
+      landed[i] = 0;
+    }
+    sim::motorCommit( ports, IQ_MAX_DEVICE_PORTS );
+    if( _sendCount == 0 )
+      return;
+
+    sim::usec_t t = sim::now();
+    uint32_t    n = 0;
+    for( int32_t k = 0; k < _sendCount; k++ ) {
+      if( !_joined[k] )
+        n++;
+      int32_t i = _sends[k];
+      landed[i] = (sim::usec_t)n * SIM_MOTOR_SEND_US;
+      if( sim::trace.motorSent )
+        sim::trace.motorSent( i, t + landed[i] );
+    }
+
+    _bus.ticks++;
+    _bus.transactions     += n;
+    _bus.setpoints        += _sendCount;
+    _bus.lastTransactions  = n;
+    _bus.maxTransactions   = std::max( _bus.maxTransactions, n );
+    _sendCount = 0;
+}
+
+sim::controllerState &
+sim::controllerGet() {
+    return( _controller );
+}
+
+sim::brainState &
+sim::brainGet() {
+    return( _brain );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Inputs                                                                    */
+/*----------------------------------------------------------------------------*/
+
+void
+sim::setSonar( int32_t port, int32_t mm ) {
+    sim::port *p = portGet( port );
+    if( p )
+      p->sonar.distance = mm;
+}
+
+void
+sim::setGyro( int32_t port, double deg, double dps ) {
+    sim::port *p = portGet( port );
+    if( p ) {
+      p->gyro.angle = deg;
+      p->gyro.rate  = dps;
+    }
+}
+
+void
+sim::setAxis( int32_t axis, int32_t percent ) {
+    if( axis >= 0 && axis < 4 )
+      _controller.axis[axis] = (percent * 127) / 100;
+}
+
+void
+sim::setButton( int32_t button, bool pressed ) {
+    if( button < 0 || button >= 10 )
+      return;
+    if( pressed )
+      _controller.buttons |=  (1 << button);
+    else
+      _controller.buttons &= ~(1 << button);
+}
+
+void
+sim::setBrainButton( int32_t button, bool pressed ) {
+    if( button < 0 || button >= 3 )
+      return;
+    if( pressed )
+      _brain.buttons |=  (1 << button);
+    else
+      _brain.buttons &= ~(1 << button);
+}
+
+void
+sim::setBattery( int32_t percent ) {
+    _brain.battery = percent;
+    _brain.voltage = 6.0 + 2.4 * percent / 100.0;
+}
+
+void
+sim::setMotorLoad( int32_t port, const motorLoad &load ) {
+    if( port >= 0 && port < IQ_MAX_DEVICE_PORTS )
+      _ports[port].load = load;
+}
+
+void
+sim::setMotorSpread( int32_t port, const motorSpread &spread ) {
+    if( port >= 0 && port < IQ_MAX_DEVICE_PORTS )
+      _ports[port].spread = spread;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Device poll, this is what vexos does between user tasks                   */
+/*----------------------------------------------------------------------------*/
+
+// the one place devices are read, once each per tick
+static void
+frameSample() {
+    _frame.tick++;
+    _frame.time  = sim::now();
+    _frame.reads = 0;
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ ) {
+      if( _ports[i].type == kDeviceTypeNoSensor && _frame.ports[i].type == kDeviceTypeNoSensor )
+        continue;
+      _frame.ports[i] = _ports[i];
+      _frame.reads++;
+    }
+    _frame.controller = _controller;
+    _frame.brain      = _brain;
+}
+
+const sim::frame &
+sim::frameGet() {
+    return( _frame );
+}
+
+static void
+devicePoll( void * ) {
+    static int32_t  lastSonar[IQ_MAX_DEVICE_PORTS];
+    static int32_t  lastGyro[IQ_MAX_DEVICE_PORTS];
+    static bool     lastFound[IQ_MAX_DEVICE_PORTS];
+    static int32_t  lastAxis[4];
+    static uint32_t lastButtons = 0;
+    static uint32_t lastBrain   = 0;
+
+    // whatever was drawn last tick goes to the screen
+    sim::lcdPush();
+
+    // profiled moves queue their next setpoint with the rest of the commands
+    sim::motionStep();
+
+    // a motor runs on its old command until the new one lands
+    sim::usec_t landed[IQ_MAX_DEVICE_PORTS];
+    motorSendAll( landed );
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ ) {
+      if( _ports[i].type != kDeviceTypeMotorSensor )
+        continue;
+      sim::usec_t before = std::min( landed[i], (sim::usec_t)SIM_POLL_INTERVAL * 1000 );
+      if( before > 0 ) {
+        sim::motorModel( _ports[i], _sent[i], _brain.voltage, before / 1e6 );
+        _sent[i] = _ports[i].motor;
+      }
+      sim::motorModel( _ports[i], _sent[i], _brain.voltage, SIM_POLL_INTERVAL / 1000.0 - before / 1e6 );
+    }
+
+    // events are raised from the same readings the handlers will see
+    frameSample();
+    const sim::frame &f = _frame;
+
+    for( int32_t i = 0; i < IQ_MAX_DEVICE_PORTS; i++ ) {
+      const sim::port &p = f.ports[i];
+      if( p.type == kDeviceTypeSonarSensor && p.sonar.distance != lastSonar[i] ) {
+        bool found = p.sonar.distance < 1000;
+        lastSonar[i] = p.sonar.distance;
+        sim::eventFire( i, SIM_SONAR_EVENT_CHANGED | ((found && !lastFound[i]) ? SIM_SONAR_EVENT_OBJECT : 0), p.sonar.distance );
+        lastFound[i] = found;
+      }
+      // the gyro reads in tenths of a degree, finer changes are not seen
+      if( p.type == kDeviceTypeGyroSensor && lround( p.gyro.angle * 10 ) != lastGyro[i] ) {
+        lastGyro[i] = lround( p.gyro.angle * 10 );
+        sim::eventFire( i, SIM_GYRO_EVENT_CHANGED, lastGyro[i] );
+      }
+    }
+
+    // controller, axis changes one at a time as each carries its reading
+    for( int32_t a = 0; a < 4; a++ ) {
+      if( f.controller.axis[a] != lastAxis[a] ) {
+        lastAxis[a] = f.controller.axis[a];
+        sim::eventFire( SIM_INDEX_CONTROLLER, 1 << (16 + a), (f.controller.axis[a] * 100) / 127 );
+      }
+    }
+
+    // then button edges
+    uint32_t mask  = 0;
+    uint32_t edges = f.controller.buttons ^ lastButtons;
+    for( int32_t b = 0; b < 10; b++ ) {
+      if( !(edges & (1 << b)) )
+        continue;
+      int32_t bit = (b < 8) ? (2 * b) : (20 + 2 * (b - 8));
+      mask |= (f.controller.buttons & (1 << b)) ? (1 << bit) : (1 << (bit + 1));
+    }
+    lastButtons = f.controller.buttons;
+    if( mask )
+      sim::eventFire( SIM_INDEX_CONTROLLER, mask );
+
+    // brain buttons
+    mask  = 0;
+    edges = f.brain.buttons ^ lastBrain;
+    for( int32_t b = 0; b < 3; b++ ) {
+      if( edges & (1 << b) )
+        mask |= (f.brain.buttons & (1 << b)) ? (1 << (2 * b)) : (2 << (2 * b));
+    }
+    lastBrain = f.brain.buttons;
+    if( mask )
+      sim::eventFire( SIM_INDEX_BRAIN, mask );
+
+    sim::callAt( sim::now() + SIM_POLL_INTERVAL * 1000, devicePoll, NULL );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Input scripts                                                             */
+/*----------------------------------------------------------------------------*/
+
+struct scriptEntry {
+    uint32_t  time;     // mS
+    char      cmd[16];
+    char      arg1[16];
+    int32_t   arg2;
+    int32_t   index;    // port, axis or button arg1 names, looked up on loading
+};
+
+static std::vector<scriptEntry>   _script;
+static size_t                     _scriptNext = 0;
+
+static const char * const         _axes[]         = { "A", "B", "C", "D" };
+static const char * const         _buttons[]      = { "EUp", "EDown", "FUp", "FDown", "LUp", "LDown", "RUp", "RDown", "L3", "R3" };
+static const char * const         _brainButtons[] = { "up", "down", "check" };
+
+static int32_t
+lookup( const char *name, const char * const *names, int32_t count ) {
+    for( int32_t i = 0; i < count; i++ ) {
+      if( strcasecmp( name, names[i] ) == 0 )
+        return( i );
+    }
+    return( -1 );
+}
+
+// a whole number from low to high, -1 if arg is anything else
+static int32_t
+number( const char *arg, int32_t low, int32_t high ) {
+    char *end;
+    long  n = strtol( arg, &end, 10 );
+    if( end == arg || *end != 0 || n < low || n > high )
+      return( -1 );
+    return( (int32_t)n );
+}
+
+//
+// Looks up what a line names, so a typo is reported with its line when the
+// script is loaded rather than quietly running something else
+//
+static bool
+scriptCheck( scriptEntry &e, const char *path, int lineno ) {
+    const char *what;
+
+    if( strcmp( e.cmd, "sonar" ) == 0 ) {
+      e.index = number( e.arg1, 1, IQ_MAX_DEVICE_PORTS ) - 1;
+      what    = "port";
+    }
+    else
+    if( strcmp( e.cmd, "axis" ) == 0 ) {
+      e.index = lookup( e.arg1, _axes, 4 );
+      what    = "axis";
+    }
+    else
+    if( strcmp( e.cmd, "button" ) == 0 ) {
+      e.index = lookup( e.arg1, _buttons, 10 );
+      what    = "button";
+    }
+    else
+    if( strcmp( e.cmd, "brain" ) == 0 ) {
+      e.index = lookup( e.arg1, _brainButtons, 3 );
+      what    = "brain button";
+    }
+    else
+    if( strcmp( e.cmd, "battery" ) == 0 ) {
+      e.index = number( e.arg1, 0, 100 );
+      what    = "battery percent";
+    }
+    else
+    if( strcmp( e.cmd, "screen" ) == 0 )
+      return( true );
+    else {
+      fprintf( stderr, "sim: %s:%d: no input %s\n", path, lineno, e.cmd );
+      return( false );
+    }
+
+    if( e.index < 0 ) {
+      fprintf( stderr, "sim: %s:%d: no %s %s\n", path, lineno, what, e.arg1 );
+      return( false );
+    }
+    return( true );
+}
+
+static void
+scriptApply( const scriptEntry &e ) {
+    if( strcmp( e.cmd, "sonar" ) == 0 )
+      sim::setSonar( e.index, e.arg2 );
+    else
+    if( strcmp( e.cmd, "axis" ) == 0 )
+      sim::setAxis( e.index, e.arg2 );
+    else
+    if( strcmp( e.cmd, "button" ) == 0 )
+      sim::setButton( e.index, e.arg2 != 0 );
+    else
+    if( strcmp( e.cmd, "brain" ) == 0 )
+      sim::setBrainButton( e.index, e.arg2 != 0 );
+    else
+    if( strcmp( e.cmd, "battery" ) == 0 )
+      sim::setBattery( e.index );
+    else
+    if( strcmp( e.cmd, "screen" ) == 0 ) {
+      sim::lcdPush();
+      sim::lcdDump( stdout );
+    }
+}
+
+static void
+scriptStep( void * ) {
+    uint32_t t = sim::now() / 1000;
+    while( _scriptNext < _script.size() && _script[_scriptNext].time <= t )
+      scriptApply( _script[_scriptNext++] );
+
+    if( _scriptNext < _script.size() )
+      sim::callAt( (sim::usec_t)_script[_scriptNext].time * 1000, scriptStep, NULL );
+}
+
+bool
+sim::scriptLoad( const char *path ) {
+    FILE *fp = fopen( path, "r" );
+    if( fp == NULL ) {
+      fprintf( stderr, "sim: cannot open script %s\n", path );
+      return( false );
+    }
+
+    char line[128];
+    int  lineno = 0;
+    while( fgets( line, sizeof(line), fp ) ) {
+      lineno++;
+      char *p = line + strspn( line, " \t" );
+      if( *p == '#' || *p == '\n' || *p == 0 )
+        continue;
+
+      scriptEntry e = {};
+      int n = sscanf( p, "%u %15s %15s %d", &e.time, e.cmd, e.arg1, &e.arg2 );
+      if( n < 2 ) {
+        fprintf( stderr, "sim: %s:%d: bad line\n", path, lineno );
+        continue;
+      }
+      if( scriptCheck( e, path, lineno ) )
+        _script.push_back( e );
+    }
+    fclose( fp );
+
+    std::stable_sort( _script.begin(), _script.end(),
+                      []( const scriptEntry &a, const scriptEntry &b ) { return( a.time < b.time ); } );
+    return( true );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Run control                                                               */
+/*----------------------------------------------------------------------------*/
+
+static void
+usermainEntry( void *arg ) {
+    ((int (*)(void))arg)();
+}
+
+void
+sim::start( int (* usermain)(void) ) {
+    taskCreate( usermainEntry, (void *)usermain, task::taskPriorityNormal, (void *)usermain, "main" );
+    callAt( now(), devicePoll, NULL );
+    logStart();
+    if( _script.size() )
+      callAt( (usec_t)_script[0].time * 1000, scriptStep, NULL );
+}
+
+void
+sim::runFor( uint32_t duration ) {
+    run( now() + (usec_t)duration * 1000 );
+}
@@ -0,0 +1,392 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_sim.h
+//    Description:  Simulated IQ hardware behind the host runtime
+//
+//----------------------------------------------------------------------------
+
+#ifndef   VEX_SIM_H
+#define   VEX_SIM_H
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "iq_cpp.h"
+#include "vex_telemetry.h"
+#include "sim_kernel.h"
+
+// Everything the brain would read from a smart port, the controller radio
+// or its own buttons lives here. The runtime classes read and write this
+// state, input scripts and benchmarks poke it from outside.
+
+namespace vex {
+  namespace sim {
+    // event indexes that are not smart ports
+    #define SIM_INDEX_BRAIN       (IQ_MAX_DEVICE_PORTS + 0)
+    #define SIM_INDEX_CONTROLLER  (IQ_MAX_DEVICE_PORTS + 1)
+    #define SIM_INDEX_USER        (IQ_MAX_DEVICE_PORTS + 8)
+    #define SIM_INDEX_MAX         (IQ_MAX_DEVICE_PORTS + 32)
+
+    // event dispatch table capacity
+    #define SIM_EVENT_SLOTS       16          // handlers on one index
+    #define SIM_EVENT_MAX         128         // handlers in total
+
+    #define SIM_POLL_INTERVAL     10          // mS between device updates
+    #define SIM_MATCH_TIME        120000      // mS, default run length
+
+    // IQ smart motor constants
+    #define SIM_MOTOR_COUNTS      960         // encoder counts per revolution
+    #define SIM_MOTOR_MAX_RPM     120
+    #define SIM_MOTOR_MAX_AMPS    1.2
+    #define SIM_MOTOR_STALL_NM    0.414
+
+    //
+    // The motor model, see sim_motor.cpp. A DC motor and gearbox seen from
+    // the output shaft, free speed SIM_MOTOR_MAX_RPM at SIM_MOTOR_VOLTS and
+    // SIM_MOTOR_STALL_NM at the SIM_MOTOR_MAX_AMPS the firmware limits it
+    // to, with the rotor's inertia through the gearbox, gearbox drag and a
+    // lumped thermal mass. It is stepped SIM_MOTOR_STEPS times a poll
+    //
+    #define SIM_MOTOR_VOLTS       7.2         // battery the free speed is for
+    #define SIM_MOTOR_OHMS        3.0         // winding, 2.4A stall at 7.2V without the limit
+    #define SIM_MOTOR_INERTIA     0.0033      // kg m2 at the output
+    #define SIM_MOTOR_FRICTION    0.01        // Nm at the output
+    #define SIM_MOTOR_AMBIENT     25.0        // C
+    #define SIM_MOTOR_HOT         70.0        // C, overtemp flag set
+    #define SIM_MOTOR_COOLED      65.0        // C, and cleared
+    #define SIM_MOTOR_HOT_LIMIT   50.0        // pct of the current limit left when hot
+    #define SIM_MOTOR_HEAT_MASS   8.0         // J per C
+    #define SIM_MOTOR_HEAT_LOSS   20.0        // C per W to ambient
+    #define SIM_MOTOR_STEPS       2           // model steps per poll, 5mS is well inside the loop response
+
+    enum class motorMode {
+      coast = 0,
+      brake,
+      hold,
+      velocity,
+      position,
+      voltage
+    };
+
+    // what the motor firmware has been asked to do and what it reports back
+    struct motorState {
+      motorMode   mode;
+      double      command;      // pct for velocity and position mode, volts for voltage mode
+      double      target;       // encoder counts, position mode
+      double      maxTorque;    // pct
+      double      position;     // encoder counts
+      double      velocity;     // rpm
+      double      current;      // amps
+      double      voltage;      // volts across the windings
+      double      temperature;  // celsius
+      uint8_t     flags;
+      double      integral;     // velocity loop, amps
+    };
+
+    // what the motor is driving, on top of its own rotor and gearbox
+    struct motorLoad {
+      double      inertia;      // kg m2
+      double      friction;     // Nm, against the motion
+      double      torque;       // Nm, constant, against positive rotation
+      bool        stops;        // hard stops at low and high
+      double      low;          // encoder counts
+      double      high;
+    };
+
+    // how far one motor is from the model's constants, every motor is a
+    // little different, pct and 0 for the motor the constants describe
+    struct motorSpread {
+      double      ohms;         // SIM_MOTOR_OHMS
+      double      heatMass;     // SIM_MOTOR_HEAT_MASS
+      double      heatLoss;     // SIM_MOTOR_HEAT_LOSS
+    };
+
+    struct sonarState {
+      int32_t     distance;     // mm
+    };
+
+    struct gyroState {
+      double      angle;        // deg, counterclockwise from where it started
+      double      rate;         // dps, counterclockwise
+    };
+
+    struct port {
+      IQ_DeviceType   type;
+      motorState      motor;
+      motorLoad       load;
+      motorSpread     spread;
+      sonarState      sonar;
+      gyroState       gyro;
+    };
+
+    // run a motor for dt seconds on command c, with volts from the battery
+    void              motorModel( port &p, const motorState &c, double volts, double dt );
+
+    struct controllerState {
+      int32_t     axis[4];      // -127 to 127
+      uint32_t    buttons;      // bit per controller::tButtonType
+    };
+
+    struct brainState {
+      uint32_t    buttons;      // bit 0 up, bit 1 down, bit 2 check
+      int32_t     battery;      // pct
+      double      voltage;      // volts
+    };
+
+    // event masks the device poll fires, these match the private
+    // tEventType values in the device class headers
+    #define SIM_SONAR_EVENT_OBJECT      0x01
+    #define SIM_SONAR_EVENT_CHANGED     0x02
+    #define SIM_GYRO_EVENT_CHANGED      0x02
+
+    //
+    // One control tick of readings. The device poll reads every installed
+    // device once per tick into here and every accessor reads from it, so
+    // readings taken in the same tick agree with each other
+    //
+    struct frame {
+      uint32_t          tick;
+      usec_t            time;
+      uint32_t          reads;        // devices read to fill it
+      port              ports[IQ_MAX_DEVICE_PORTS];
+      controllerState   controller;
+      brainState        brain;
+    };
+
+    const frame      &frameGet( void );
+
+    port             *portGet( int32_t index );
+    void              portInstall( int32_t index, IQ_DeviceType type );
+    controllerState  &controllerGet( void );
+    brainState       &brainGet( void );
+
+    //
+    // Motor command bus. A command is written to the port straight away
+    // but the motor only gets it when the next device poll sends it, one
+    // SIM_MOTOR_SEND_US transaction per command in the order they were
+    // made, and it carries on with what it was last sent until then. A
+    // held port keeps its commands back and sends only the last one, the
+    // ports in a commit go in one transaction and so land together. Held
+    // ports not committed by the next poll are all sent in one then.
+    //
+    #define SIM_MOTOR_SEND_US     250         // nominal time for one bus transaction
+    #define SIM_MOTOR_SENDS       256         // commands one poll can queue
+    #define SIM_GROUP_MOTORS      12          // motors one motor_group can hold
+
+    struct busStats {
+      uint32_t    ticks;              // polls that sent anything
+      uint64_t    transactions;       // sent
+      uint64_t    setpoints;          // commands carried by them
+      uint32_t    lastTransactions;   // by the last of those polls
+      uint32_t    maxTransactions;    // by the busiest poll
+    };
+
+    void              motorSend( int32_t index );
+    void              motorHold( int32_t index, bool held );
+    void              motorCommit( const int32_t *index, int32_t count );
+    const busStats   &busStatsGet( void );
+
+    //
+    // What a motor_group reads from each of its motors, kept by port as the
+    // motor has to stay the size libiq makes it. The motor sets it when it
+    // is made, reversed or given a move, and every group holding the port
+    // takes a copy, so the group's queries never go through the motor
+    //
+    struct motorConfig {
+      bool        reverse;
+      float       gearRatio;
+      int32_t     flagDelay;          // frame tick the last move was made in
+    };
+
+    void              motorConfigure( int32_t index, const motorConfig &c );
+
+    //
+    // The monochrome IQ panel. Brain.Screen draws into an off-screen
+    // buffer, one bit per pixel, set is black. Once a tick the
+    // buffer is compared with what the screen shows, which is held the
+    // way the display controller holds it, 8 pixel rows to a byte, and
+    // only the changed span of each 8 row page is sent
+    //
+    #define SIM_LCD_WIDTH       128
+    #define SIM_LCD_HEIGHT      64
+    #define SIM_LCD_PAGES       (SIM_LCD_HEIGHT / 8)
+    #define SIM_LCD_PAGE_SETUP  3           // command bytes to address a span
+
+    struct lcdStats {
+      uint32_t    frames;         // pushes that sent anything
+      uint32_t    lastBytes;      // bytes sent by the last of those
+      uint64_t    bytes;          // all bytes sent
+      uint64_t    fullBytes;      // what redrawing the whole screen each time would have sent
+    };
+
+    bool              lcdPixel( int32_t x, int32_t y );
+    void              lcdPush( void );
+    void              lcdDump( FILE *fp );
+    void              lcdSavePbm( FILE *fp );
+    const lcdStats   &lcdStatsGet( void );
+
+    //
+    // Profiled moves, see vex_motion.h. A move is built into a table with
+    // an entry per SIM_POLL_INTERVAL, where the motor should be at the end
+    // of that tick and the speed that gets it there, in encoder counts and
+    // counts per second. Each device poll feeds every moving motor its next
+    // entry before commands are sent, in velocity mode, at the speed the
+    // table has SIM_MOTION_LEAD later as the motor takes time to respond,
+    // corrected for how far behind it is and never turning round. After
+    // the last one the motor is put in position mode on the target, so it
+    // finishes like any other move
+    //
+    #define SIM_MOTION_LEAD       0.035       // S the motor takes to respond, and half a tick
+    #define SIM_MOTION_CATCHUP    0.1         // S to make up a position error in
+
+    struct setpoint {
+      double      position;
+      double      velocity;
+    };
+
+    // distance, velocity, acceleration and jerk in counts, jerk 0 for a trapezoid
+    void              motionBuild( std::vector<setpoint> &table, double distance, double velocity, double acceleration, double jerk );
+    void              motionStart( int32_t index, double target, double velocity, double acceleration, double jerk );
+    void              motionStop( int32_t index );
+
+    // vex_motion.h's spinTo and spinFor arm a profile for the task that
+    // calls them, in the profile's own units, and make the motor's move.
+    // motionMove is where the motor's move lands, with its target and the
+    // counts per second one of its velocity units is. It starts the armed
+    // profile when the current task has one and stops any profiled move on
+    // the port when it does not
+    void              motionArm( double velocity, double acceleration, double jerk );
+    void              motionDisarm( void );
+    void              motionMove( int32_t index, double target, double counts );
+    bool              motionActive( int32_t index );
+    void              motionStep( void );
+
+    // broadcast to every handler registered on index for any bit in mask,
+    // value is the new reading for events that carry one
+    void              eventFire( int32_t index, uint32_t mask, int32_t value = 0 );
+
+    //
+    // Coalescing for events that fire on every new reading, a handler with
+    // a policy never has more than one invocation pending
+    //   latest      triggers while one is pending fold into it
+    //   interval    as latest, and starts are at least value mS apart
+    //   hysteresis  as latest, and the reading must have moved by value
+    //               since the last trigger that was taken
+    // Rules apply to handlers already registered and ones registered later
+    // on index for any bit in mask, so a rule for one controller axis leaves
+    // the buttons and other axes alone. callback NULL matches every handler
+    // on those bits.
+    //
+    #define SIM_COALESCE_MAX      16
+
+    enum class coalesceType { none, latest, interval, hysteresis };
+
+    struct coalescePolicy {
+      coalesceType  type;
+      int32_t       value;
+    };
+
+    bool              eventCoalesce( int32_t index, uint32_t mask, const void *callback, coalescePolicy policy );
+
+    // what the most recent broadcastAndWait saw
+    struct eventWait {
+      int32_t       index;
+      int32_t       handlers;       // handlers the broadcast woke
+      int32_t       finished;       // how many of those returned in time
+      int32_t       last;           // slot of the one that returned last, -1 if none
+      const void   *lastCallback;
+      bool          timedout;
+      usec_t        elapsed;
+    };
+    const eventWait  &eventLastWait( void );
+
+    //
+    // Opt-in handler profiler, per callback it keeps the invocation count
+    // and histograms of run time and of the delay from trigger to start
+    //
+    #define SIM_PROFILE_BUCKETS   13          // <1mS, <2mS ... <2S, longer
+    #define SIM_PROFILE_DEPTH     32          // trigger times kept per handler
+
+    void              profileEnable( bool on );
+    void              profileDump( FILE *fp );
+
+    //
+    // Deferred logging, see vex_log.h. A record in the ring is a header
+    // word (length in words, sink, argument count and kinds), the format
+    // string's address, the time in uS, then a word per argument, a string
+    // argument is its length followed by its characters. The drain task
+    // formats what is queued every SIM_LOG_INTERVAL, or with a log file set
+    // writes the records there for logdecode instead
+    //
+    #define SIM_LOG_WORDS         4096        // ring size in 8 byte words
+    #define SIM_LOG_TEXT          64          // longest string argument kept
+    #define SIM_LOG_INTERVAL      10          // mS between drains
+    #define SIM_LOG_FORMATS       256         // distinct formats in a log file
+    #define SIM_LOG_MAGIC         "vexlog1\n"
+    #define SIM_LOG_LENGTH(h)     ((uint32_t)((h) & 0xFFFF))
+    #define SIM_LOG_SINK(h)       ((uint32_t)(((h) >> 16) & 0xFF))
+
+    void              logStart( void );
+    void              logFile( FILE *fp );
+    // format one record held contiguously, format is its format string
+    int32_t           logRender( const uint64_t *rec, const char *format, char *buf, size_t len );
+
+    //
+    // Telemetry, see vex_telemetry.h. A kernel timer samples every motor
+    // added, so a tick runs outside any task and costs the same whatever
+    // the tasks are doing. The binary file is SIM_TELEMETRY_MAGIC, the
+    // sample count and how many were lost as 4 byte words, then each
+    // sample packed into SIM_TELEMETRY_RECORD bytes in the order of its
+    // fields, little endian
+    //
+    #define SIM_TELEMETRY_SAMPLES 65536       // ring size, a power of 2
+    #define SIM_TELEMETRY_MOTORS  16          // motors sampled together
+    #define SIM_TELEMETRY_RATE    10          // mS between samples baller --telemetry-file takes
+    #define SIM_TELEMETRY_MAGIC   "vextlm1\n"
+    #define SIM_TELEMETRY_RECORD  29          // time, port, 6 floats
+    #define SIM_TELEMETRY_HEADER  "time_ms,port,position_deg,velocity_rpm,current_a,voltage_v,torque_nm,temperature_c\n"
+
+    // take one sample of every motor, the timer calls this
+    void              telemetrySample( void );
+    void              telemetryRow( FILE *fp, const telemetry::sample &s );
+    void              telemetryUnpack( const uint8_t *rec, telemetry::sample &s );
+
+    //
+    // Trace hooks for benchmarks and tools, NULL when not used
+    // they are called inline from the runtime so keep them short
+    //
+    struct traceHooks {
+      void  (* eventFire)( int32_t index, uint32_t mask );
+      void  (* handlerStart)( int32_t index, uint32_t mask );
+      void  (* handlerEnd)( int32_t index, uint32_t mask );
+      void  (* motorCommand)( int32_t index, const motorState &m );
+      void  (* motorSent)( int32_t index, usec_t time );
+    };
+    extern traceHooks trace;
+
+    //
+    // Inputs, these behave like the hardware changing under the program
+    // and are picked up at the next device poll
+    //
+    void              setSonar( int32_t port, int32_t mm );
+    void              setGyro( int32_t port, double deg, double dps );
+    void              setAxis( int32_t axis, int32_t percent );
+    void              setButton( int32_t button, bool pressed );
+    void              setBrainButton( int32_t button, bool pressed );
+    void              setBattery( int32_t percent );
+    void              setMotorLoad( int32_t port, const motorLoad &load );
+    void              setMotorSpread( int32_t port, const motorSpread &spread );
+
+    // load a timed input script, see README for the format
+    bool              scriptLoad( const char *path );
+
+    //
+    // Start the device poll and run for duration mS
+    //
+    void              start( int (* usermain)(void) );
+    void              runFor( uint32_t duration );
+  };
+};
+
+#endif // VEX_SIM_H
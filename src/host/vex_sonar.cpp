@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_sonar.cpp
+//    Description:  Host implementation of vex::sonar
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+sonar::sonar( int32_t index ) : device( index ) {
+    _eventId_1   = 0;
+    _maxdistance = 1000;
+    _mindistance = 50;
+    _distance    = 0;
+    setPollInterval( 20 );
+    sim::portInstall( index, kDeviceTypeSonarSensor );
+}
+
+sonar::~sonar() {
+}
+
+bool
+sonar::installed() {
+    return( type() == kDeviceTypeSonarSensor );
+}
+
+// the reading from this tick's frame, not the port itself
+int32_t
+sonar::value() {
+    if( _index >= 0 && _index < IQ_MAX_DEVICE_PORTS )
+      _distance = sim::frameGet().ports[_index].sonar.distance;
+    else
+      _distance = _maxdistance;
+    return( _distance );
+}
+
+void
+sonar::setMaximum( double distance, distanceUnits units ) {
+    _maxdistance = distanceToRaw( distance, units );
+}
+
+void
+sonar::setMinimum( double distance, distanceUnits units ) {
+    _mindistance = distanceToRaw( distance, units );
+}
+
+void
+sonar::setFilter( uint32_t value ) {
+}
+
+void
+sonar::setBrightnessThreshold( uint32_t value ) {
+}
+
+double
+sonar::distance( distanceUnits units ) {
+    uint32_t raw = value();
+    if( raw < _mindistance )
+      raw = _mindistance;
+    if( raw > _maxdistance )
+      raw = _maxdistance;
+    return( rawToDistance( raw, units ) );
+}
+
+bool
+sonar::foundObject() {
+    return( (uint32_t)value() < _maxdistance );
+}
+
+void
+sonar::objectDetected( void (* callback)(void) ) {
+    event::init( _index, (uint32_t)tEventType::EVENT_OBJECT, callback );
+}
+
+void
+sonar::changed( void (* callback)(void) ) {
+    event::init( _index, (uint32_t)tEventType::EVENT_CHANGED, callback );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  raw units are mm                                                          */
+/*----------------------------------------------------------------------------*/
+
+uint32_t
+sonar::distanceToRaw( double distance, distanceUnits units ) {
+    switch( units ) {
+      case distanceUnits::in: return( distance * 25.4 );
+      case distanceUnits::cm: return( distance * 10 );
+      default:                return( distance );
+    }
+}
+
+double
+sonar::rawToDistance( uint32_t raw, distanceUnits units ) {
+    switch( units ) {
+      case distanceUnits::in: return( raw / 25.4 );
+      case distanceUnits::cm: return( raw / 10.0 );
+      default:                return( raw );
+    }
+}
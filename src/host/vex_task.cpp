@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_task.cpp
+//    Description:  Host implementation of vex::task and vex::semaphore
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+int  task::_labelId = 0;
+bool semaphore::_initialized = false;
+
+static void
+taskEntry( void *arg ) {
+    ((int (*)(void))arg)();
+}
+
+/*----------------------------------------------------------------------------*/
+/*  task                                                                      */
+/*----------------------------------------------------------------------------*/
+
+task::task() : _callback( NULL ) {
+}
+
+task::task( int (* callback)(void) ) : task( callback, taskPriorityNormal ) {
+}
+
+task::task( int (* callback)(void), uint16_t priority ) : _callback( callback ) {
+    sim::taskCreate( taskEntry, (void *)callback, priority, (void *)callback, "task" );
+}
+
+task::~task() {
+}
+
+int32_t
+task::_index( int (* callback)(void) ) {
+    return( sim::taskId( sim::taskFind( (void *)callback ) ) );
+}
+
+void
+task::_stopAll() {
+    sim::taskDeleteTagged();
+}
+
+void
+task::stop( const task &t ) {
+    sim::taskDelete( sim::taskFind( (void *)t._callback ) );
+}
+
+void
+task::suspend( const task &t ) {
+    sim::taskSuspend( sim::taskFind( (void *)t._callback ) );
+}
+
+void
+task::resume( const task &t ) {
+    sim::taskResume( sim::taskFind( (void *)t._callback ) );
+}
+
+int16_t
+task::priority( const task &t ) {
+    return( sim::taskPriority( sim::taskFind( (void *)t._callback ) ) );
+}
+
+void
+task::setPriority( const task &t, uint16_t priority ) {
+    sim::taskSetPriority( sim::taskFind( (void *)t._callback ), priority );
+}
+
+void
+task::stop() {
+    stop( *this );
+}
+
+void
+task::suspend() {
+    suspend( *this );
+}
+
+void
+task::resume() {
+    resume( *this );
+}
+
+int16_t
+task::priority() {
+    return( priority( *this ) );
+}
+
+void
+task::setPriority( uint16_t priority ) {
+    setPriority( *this, priority );
+}
+
+int16_t
+task::index() {
+    return( _index( _callback ) );
+}
+
+void
+task::sleep( uint32_t time ) {
+    sim::taskSleep( (sim::usec_t)time * 1000 );
+}
+
+void
+task::yield() {
+    sim::taskYield();
+}
+
+void
+task::dump() {
+    sim::taskDump();
+}
+
+void
+task::stop( int (* callback)(void) ) {
+    sim::taskDelete( sim::taskFind( (void *)callback ) );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  semaphore                                                                 */
+/*----------------------------------------------------------------------------*/
+
+semaphore::semaphore() {
+    _initialized = true;
+    _sem = sim::semCreate();
+}
+
+semaphore::~semaphore() {
+    sim::semDelete( _sem );
+}
+
+void
+semaphore::lock() {
+    sim::semLock( _sem, 0 );
+}
+
+void
+semaphore::lock( uint32_t time ) {
+    sim::semLock( _sem, (sim::usec_t)time * 1000 );
+}
+
+void
+semaphore::unlock() {
+    sim::semUnlock( _sem );
+}
+
+bool
+semaphore::owner() {
+    return( sim::semOwner( _sem ) );
+}
@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_telemetry.cpp
+//    Description:  Host implementation of vex::telemetry, a ring of motor samples
+//
+//----------------------------------------------------------------------------
+
+// The ring is a static array, _head counts every sample ever taken and the
+// oldest held is max(0, _head - SIM_TELEMETRY_SAMPLES), so there is no tail
+// to keep. A tick reads each motor through the same calls the program
+// would use. Ticks are scheduled from when the last one was due rather
+// than when it ran, so the rate does not drift, and each carries the run
+// it belongs to so one left on the timer after stop and start does nothing.
+
+#include <string.h>
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+#define TELEMETRY_MASK  (SIM_TELEMETRY_SAMPLES - 1)
+
+static_assert( (SIM_TELEMETRY_SAMPLES & TELEMETRY_MASK) == 0, "SIM_TELEMETRY_SAMPLES must be a power of 2" );
+
+static telemetry::sample  _ring[SIM_TELEMETRY_SAMPLES];
+static uint64_t           _head;
+
+static motor             *_motors[SIM_TELEMETRY_MOTORS];
+static int32_t            _count;
+
+static uint32_t           _interval;    // mS
+static sim::usec_t        _due;
+static uintptr_t          _run;         // 0 when stopped
+
+/*----------------------------------------------------------------------------*/
+/*  Sampling                                                                  */
+/*----------------------------------------------------------------------------*/
+
+void
+sim::telemetrySample() {
+    uint32_t time = timer::system();
+
+    for( int32_t i = 0; i < _count; i++ ) {
+      motor             &m = *_motors[i];
+      telemetry::sample &s = _ring[_head++ & TELEMETRY_MASK];
+      s.time        = time;
+      s.port        = (uint8_t)m.index();
+      s.position    = (float)m.position( rotationUnits::deg );
+      s.velocity    = (float)m.velocity( velocityUnits::rpm );
+      s.current     = (float)m.current( currentUnits::amp );
+      s.voltage     = (float)m.voltage( voltageUnits::volt );
+      s.torque      = (float)m.torque( torqueUnits::Nm );
+      s.temperature = (float)m.temperature( temperatureUnits::celsius );
+    }
+}
+
+static void
+tick( void *arg ) {
+    if( (uintptr_t)arg != _run )
+      return;
+    sim::telemetrySample();
+    _due += (sim::usec_t)_interval * 1000;
+    sim::callAt( _due, tick, arg );
+}
+
+bool
+telemetry::add( motor &m ) {
+    for( int32_t i = 0; i < _count; i++ )
+      if( _motors[i] == &m )
+        return( true );
+    if( _count >= SIM_TELEMETRY_MOTORS ) {
+      fprintf( stderr, "telemetry: more than %d motors, port %d not added\n", SIM_TELEMETRY_MOTORS, m.index() + 1 );
+      return( false );
+    }
+    _motors[_count++] = &m;
+    return( true );
+}
+
+bool
+telemetry::add( motor_group &g ) {
+    bool ok = true;
+    for( int32_t i = 0; i < g.count(); i++ )
+      ok = add( *g._motor( i ) ) && ok;
+    return( ok );
+}
+
+void
+telemetry::clear() {
+    stop();
+    _count = 0;
+    _head  = 0;
+}
+
+void
+telemetry::start( uint32_t interval ) {
+    static uintptr_t runs = 0;
+
+    _interval = interval ? interval : 1;
+    _run      = ++runs;
+    _due      = sim::now();
+    tick( (void *)_run );
+}
+
+void
+telemetry::stop() {
+    _run = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Reading back                                                              */
+/*----------------------------------------------------------------------------*/
+
+uint32_t
+telemetry::count() {
+    return( (uint32_t)(_head < SIM_TELEMETRY_SAMPLES ? _head : SIM_TELEMETRY_SAMPLES) );
+}
+
+uint32_t
+telemetry::lost() {
+    return( (uint32_t)(_head - count()) );
+}
+
+bool
+telemetry::get( uint32_t index, sample &s ) {
+    if( index >= count() )
+      return( false );
+    s = _ring[(_head - count() + index) & TELEMETRY_MASK];
+    return( true );
+}
+
+void
+sim::telemetryRow( FILE *fp, const telemetry::sample &s ) {
+    fprintf( fp, "%u,%u,%.3f,%.3f,%.4f,%.4f,%.5f,%.2f\n", s.time, s.port + 1,
+             s.position, s.velocity, s.current, s.voltage, s.torque, s.temperature );
+}
+
+// the fields one after the other with no padding, the host is little endian
+static void
+pack( uint8_t *rec, const telemetry::sample &s ) {
+    memcpy( rec, &s.time, 4 );
+    rec[4] = s.port;
+    memcpy( rec + 5,  &s.position, 4 );
+    memcpy( rec + 9,  &s.velocity, 4 );
+    memcpy( rec + 13, &s.current, 4 );
+    memcpy( rec + 17, &s.voltage, 4 );
+    memcpy( rec + 21, &s.torque, 4 );
+    memcpy( rec + 25, &s.temperature, 4 );
+}
+
+void
+sim::telemetryUnpack( const uint8_t *rec, telemetry::sample &s ) {
+    memcpy( &s.time, rec, 4 );
+    s.port = rec[4];
+    memcpy( &s.position, rec + 5, 4 );
+    memcpy( &s.velocity, rec + 9, 4 );
+    memcpy( &s.current, rec + 13, 4 );
+    memcpy( &s.voltage, rec + 17, 4 );
+    memcpy( &s.torque, rec + 21, 4 );
+    memcpy( &s.temperature, rec + 25, 4 );
+}
+
+bool
+telemetry::save( const char *path, fileType type ) {
+    FILE *fp = fopen( path, type == fileType::binary ? "wb" : "w" );
+    if( fp == NULL )
+      return( false );
+
+    uint32_t n = count();
+    sample   s;
+    if( type == fileType::binary ) {
+      uint32_t header[2] = { n, lost() };
+      uint8_t  rec[SIM_TELEMETRY_RECORD];
+      fputs( SIM_TELEMETRY_MAGIC, fp );
+      fwrite( header, sizeof(header), 1, fp );
+      for( uint32_t i = 0; get( i, s ); i++ ) {
+        pack( rec, s );
+        fwrite( rec, sizeof(rec), 1, fp );
+      }
+    }
+    else {
+      fputs( SIM_TELEMETRY_HEADER, fp );
+      for( uint32_t i = 0; get( i, s ); i++ )
+        sim::telemetryRow( fp, s );
+    }
+    bool failed = ferror( fp ) != 0;
+    return( fclose( fp ) == 0 && !failed );
+}
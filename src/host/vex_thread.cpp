@@ -0,0 +1,137 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_thread.cpp
+//    Description:  Host implementation of vex::thread and vex::mutex
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+int thread::_labelId = 0;
+
+static void
+threadEntry( void *arg ) {
+    ((int (*)(void))arg)();
+}
+
+/*----------------------------------------------------------------------------*/
+/*  thread                                                                    */
+/*----------------------------------------------------------------------------*/
+
+thread::thread( int (* callback)(void) ) : _callback( callback ) {
+    sim::taskCreate( threadEntry, (void *)callback, threadPriorityNormal, (void *)callback, "thread" );
+}
+
+thread::~thread() {
+}
+
+int32_t
+thread::get_id() {
+    return( sim::taskId( sim::taskFind( (void *)_callback ) ) );
+}
+
+void
+thread::join() {
+    while( joinable() )
+      sim::taskSleep( 1000 );
+}
+
+bool
+thread::joinable() {
+    return( _callback != NULL && sim::taskFind( (void *)_callback ) != NULL );
+}
+
+void *
+thread::native_handle() {
+    return( sim::taskFind( (void *)_callback ) );
+}
+
+void
+thread::swap( thread &__t ) {
+    int (* cb)(void) = _callback;
+    _callback = __t._callback;
+    __t._callback = cb;
+}
+
+void
+thread::interrupt() {
+    sim::taskDelete( sim::taskFind( (void *)_callback ) );
+}
+
+void
+thread::setPriority( int32_t priority ) {
+    sim::taskSetPriority( sim::taskFind( (void *)_callback ), priority );
+}
+
+int32_t
+thread::priority() {
+    return( sim::taskPriority( sim::taskFind( (void *)_callback ) ) );
+}
+
+int32_t
+thread::hardware_concurrency() {
+    return( 1 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  this_thread                                                               */
+/*----------------------------------------------------------------------------*/
+
+int32_t
+this_thread::get_id() {
+    return( sim::taskId( sim::taskCurrent() ) );
+}
+
+void
+this_thread::yield() {
+    sim::taskYield();
+}
+
+void
+this_thread::sleep_for( uint32_t time ) {
+    sim::taskSleep( (sim::usec_t)time * 1000 );
+}
+
+void
+this_thread::sleep_until( uint32_t time ) {
+    sim::taskSleepUntil( (sim::usec_t)time * 1000 );
+}
+
+void
+this_thread::setPriority( int32_t priority ) {
+    sim::taskSetPriority( sim::taskCurrent(), priority );
+}
+
+int32_t
+this_thread::priority() {
+    return( sim::taskPriority( sim::taskCurrent() ) );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  mutex                                                                     */
+/*----------------------------------------------------------------------------*/
+
+mutex::mutex() {
+    _sem = sim::semCreate();
+}
+
+mutex::~mutex() {
+    sim::semDelete( _sem );
+}
+
+void
+mutex::lock() {
+    sim::semLock( _sem, 0 );
+}
+
+bool
+mutex::try_lock() {
+    return( sim::semTryLock( _sem ) );
+}
+
+void
+mutex::unlock() {
+    sim::semUnlock( _sem );
+}
@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------
+//
+//    Module:       vex_timer.cpp
+//    Description:  Host implementation of vex::timer
+//
+//----------------------------------------------------------------------------
+
+#include "vex_sim.h"
+
+using namespace vex;
+
+timer::timer() {
+    _initial = 0;
+    _offset  = system();
+}
+
+timer::~timer() {
+}
+
+void
+timer::operator=( uint32_t value ) {
+    _initial = value;
+    _offset  = system();
+}
+
+timer::operator uint32_t() const {
+    return( time() );
+}
+
+uint32_t
+timer::time() const {
+    return( system() - _offset + _initial );
+}
+
+double
+timer::time( timeUnits units ) const {
+    if( units == timeUnits::sec )
+      return( time() / 1000.0 );
+    return( time() );
+}
+
+double
+timer::value() const {
+    return( time( timeUnits::sec ) );
+}
+
+void
+timer::clear() {
+    *this = 0;
+}
+
+void
+timer::reset() {
+    *this = 0;
+}
+
+uint32_t
+timer::system() {
+    return( sim::now() / 1000 );
+}
+
+/*----------------------------------------------------------------------------*/
+/*  Timer events run once in their own task, like an event handler            */
+/*----------------------------------------------------------------------------*/
+
+static void
+eventEntry( void *arg ) {
+    ((void (*)(void))arg)();
+}
+
+static void
+eventEntryArg( void *arg ) {
+    ((void (*)(void *))arg)( NULL );
+}
+
+static void
+eventStart( void *arg ) {
+    sim::taskCreate( eventEntry, arg, task::taskPriorityNormal, NULL, "timer" );
+}
+
+static void
+eventStartArg( void *arg ) {
+    sim::taskCreate( eventEntryArg, arg, task::taskPriorityNormal, NULL, "timer" );
+}
+
+void
+timer::event( void (* callback)(void *), uint32_t value ) {
+    sim::callAt( sim::now() + (sim::usec_t)value * 1000, eventStartArg, (void *)callback );
+}
+
+void
+timer::event( void (* callback)(void), uint32_t value ) {
+    sim::callAt( sim::now() + (sim::usec_t)value * 1000, eventStart, (void *)callback );
+}
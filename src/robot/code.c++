@@ -52,65 +52,397 @@ bool RemoteControlCodeEnabled = true;
 
 // Global Variables
 bool bypass_autoclamp = false;
+
+// Auto grab settings
+#define GRAB_DISTANCE 110 // mm, object this close gets grabbed
+#define GRAB_SPEED 20 // percent
+#define GRAB_HOLD 20 // percent torque the claw holds the object with
+#define GRAB_TIME 2000 // msec to give up if the claw never closes on anything
+#define GRAB_CHECK 20 // msec between checks while the claw closes
+#define GRAB_SETTLE 50 // msec the claw gets to start moving before a stall counts
+#define GRAB_STALL_SPEED 2 // rpm, the claw is this slow once it stops on the object
+#define GRAB_STALL_CURRENT 40 // percent of the claw's max torque it draws pushing on
+                              // the object, under half so it still counts when hot
+#define GRAB_STALL_CHECKS 2 // checks in a row the claw has to be stalled for
+#define CLAW_TORQUE 100 // percent max torque the claw has when it is not holding
+
+// Claw stick settings, clawTask drives the claw from AxisD
+#define CLAW_TICK 10 // msec between reads of the stick
+#define CLAW_DEADBAND 5 // percent either side of centre that reads as stopped
+#define CLAW_CURVE 0.5 // 0 straight, 1 cubic, for finer control near the centre
+#define CLAW_SLEW 400 // percent a second the claw speed can change by
+#define CLAW_THRESHOLD 3 // percent the speed has to change by to be sent
+
+// Claw heat, the claw's temperature is worked out from the current it draws
+// and its torque cut back before it overheats in a long match
+#define CLAW_DERATE_HORIZON 10 // seconds ahead the claw looks for overheating
+#define CLAW_HOT 70 // C, the motor halves its own torque this hot
+#define CLAW_MARGIN 5 // C under CLAW_HOT the claw is kept to
+#define CLAW_AMBIENT 25 // C, the air the motor cools to
+#define CLAW_OHMS 3.0 // the motor's windings
+#define CLAW_HEAT_MASS 8.0 // J to warm the motor by 1C
+#define CLAW_HEAT_LOSS 20.0 // C over the air for every W the motor gives off
+#define CLAW_MAX_AMPS 1.2 // amps at 100 percent max torque
+#define CLAW_FILTER 1.0 // seconds the current is averaged over for clawTimeToHot
+#define CLAW_TRUST 2.0 // seconds for the estimate to come round to the motor's reading
+#define CLAW_LEARN 2.0 // how fast the estimate learns how far off CLAW_OHMS heats
+
+// Screen settings
+#define SCREEN_RATE 10 // screen updates a second
+#define SCREEN_LATE 20 // msec late before an update is skipped
+#define PAGE_FIELDS 3 // rows 2 to 4 under the title, row 5 is telemetry
+
+// Auto grab states
+// IDLE -> CLOSING when an object comes within GRAB_DISTANCE
+// CLOSING -> HOLDING once the claw stalls on the object, or after GRAB_TIME
+// CLOSING/HOLDING -> RELEASED when the driver takes over, autoclamp is
+// turned off or the object goes away, the claw lets go there and then
+// RELEASED -> IDLE on a later update with nothing in front of the claw
+enum grabStates { GRAB_IDLE, GRAB_CLOSING, GRAB_HOLDING, GRAB_RELEASED };
+grabStates grabState = GRAB_IDLE;
+uint32_t grabStarted = 0;
+int grabStalls = 0; // checks in a row the claw was stalled
+bool grabChecking = false; // a grabCheck is waiting on the timer
+double clawSetpoint = 0; // percent, the claw speed slewing towards the stick
+int clawSent = 0; // percent, the last claw speed sent
+double clawTorque = CLAW_TORQUE; // percent max torque the claw is meant to have
+int clawCap = 100; // percent max torque derating leaves the claw
+double clawTemperature = 0; // C, worked out by clawHeat
+double clawSquared = 0; // amps squared, averaged over CLAW_FILTER
+double clawGain = 1; // how much more the claw heats than CLAW_OHMS says
+uint32_t clawHeated = 0; // msec, when clawHeat last ran
+bool clawSeeded = false; // clawHeat has started from the motor's reading
+
 // Allows for easier use of the VEX Library
 using namespace vex;
 // Functions
 
+// Page system
+// A page is a title and up to PAGE_FIELDS fields, a field is a label and a
+// function that reads the value shown after it. Under every page is a
+// telemetry line with the claw position and sonar distance. Buttons only
+// pick the page, pageTask does all the drawing at a low priority and at
+// most SCREEN_RATE times a second. A field is redrawn only when its value
+// changed, so the screen stays out of the way of the control handlers.
+struct pageField {
+  const char *label;
+  int (*read)();
+  const char *units;
+};
+struct page {
+  const char *name;
+  int count;
+  pageField fields[PAGE_FIELDS];
+};
+
+int readBattery() { return Brain.Battery.capacity(); }
+int readBypass() { return bypass_autoclamp; }
+int readClaw() { return (int)claw.position(degrees); }
+int readFound() { return dist.foundObject(); }
+int readDistance() { return (int)dist.distance(mm); }
+int screenSkips = 0; // updates skipped because the handlers were behind
+int readSkips() { return screenSkips; }
+int readRate() { return SCREEN_RATE; }
+double clawTimeToHot();
+int readTemperature() { return (int)round(clawTemperature); }
+int readHotIn() { double t = clawTimeToHot(); return t > 999 ? 999 : (int)t; }
+int readCap() { return clawCap; }
+
+// Debugging pages, buttonUp and buttonDown go through them
+#define PAGE_CLAW 0
+#define PAGE_VISUAL 1
+#define PAGE_SCREEN 2
+#define PAGE_HEAT 3
+#define PAGE_COUNT 4
+page pages[PAGE_COUNT] = {
+  { "Claw", 3, {
+    { "Battery: ", readBattery, "%" },
+    { "byp: ", readBypass, "" },
+    { "Claw Pos: ", readClaw, "" } } },
+  { "Visual", 3, {
+    { "Battery: ", readBattery, "%" },
+    { "Object found: ", readFound, "" },
+    { "Distance: ", readDistance, "mm" } } },
+  { "Screen", 2, {
+    { "Rate: ", readRate, "Hz" },
+    { "Skipped: ", readSkips, "" } } },
+  { "Heat", 3, {
+    { "Claw: ", readTemperature, "C" },
+    { "Hot in: ", readHotIn, "s" },
+    { "Torque: ", readCap, "%" } } },
+};
+int currentPage = PAGE_CLAW;
+int drawnPage = -1; // page on the screen, -1 to draw it all again
+int shown[PAGE_FIELDS]; // values on the screen
+int shownClaw = 0; // telemetry on the screen
+int shownDistance = 0;
+
 //
-// EG: basicScreen(boolean);
-// Desc: Creates a basic screen
-// Vars: boolean, determines if you want to clear the screen or not (not recommended)
+// EG: showPage(PAGE_CLAW);
+// Desc: Switches the screen to a page, it is drawn on the next refresh
+// Vars: number, which page
 //
-void basicScreen(bool remove){
- //Check if you want to clear screen
-  if (remove == false) {
+void showPage(int number) {
+  currentPage = number;
+}
+void nextPage() {
+  showPage((currentPage + 1) % PAGE_COUNT);
+}
+void previousPage() {
+  showPage((currentPage + PAGE_COUNT - 1) % PAGE_COUNT);
+}
+void firstPage() {
+  showPage(PAGE_CLAW);
+}
+
+//
+// EG: drawPage();
+// Desc: Brings the screen up to date with the current page and the
+//       telemetry line, the title and labels only when the page changed,
+//       values only when they changed
+//
+void drawPage() {
+  int number = currentPage;
+  page &p = pages[number];
+  bool all = (number != drawnPage);
+  if (all) {
     Brain.Screen.clearScreen();
+    Brain.Screen.setCursor(1,1);
+    Brain.Screen.print("Baller: v1.0 %s", p.name);
+    for (int i = 0; i < p.count; i++) {
+      Brain.Screen.setCursor(i + 2,1);
+      Brain.Screen.print("%s", p.fields[i].label);
+    }
+    drawnPage = number;
+  }
+  for (int i = 0; i < p.count; i++) {
+    int value = p.fields[i].read();
+    if (all || value != shown[i]) {
+      // the value goes after its label, clear what is left of a longer one
+      Brain.Screen.setCursor(i + 2, strlen(p.fields[i].label) + 1);
+      Brain.Screen.print("%d%s", value, p.fields[i].units);
+      Brain.Screen.clearLine();
+      shown[i] = value;
+    }
+  }
+  int clawPos = readClaw();
+  int distance = readDistance();
+  if (all || clawPos != shownClaw || distance != shownDistance) {
+    Brain.Screen.setCursor(5,1);
+    Brain.Screen.print("Claw %d Dist %dmm", clawPos, distance);
+    Brain.Screen.clearLine();
+    shownClaw = clawPos;
+    shownDistance = distance;
   }
-  Brain.Screen.setCursor(1,1);
-  Brain.Screen.print("Baller: v1.0");
-  Brain.Screen.newLine();
-  Brain.Screen.setCursor(2,1);
-  Brain.Screen.print("Battery: %d%%", Brain.Battery.capacity());
+}
+int pageTask() {
+  while (true) {
+    uint32_t due = timer::system() + 1000 / SCREEN_RATE;
+    wait(1000 / SCREEN_RATE, msec);
+    // Waking up late means the handlers above us are behind, give them
+    // the time and draw on the next update instead
+    if ((int32_t)(timer::system() - due) > SCREEN_LATE) {
+      screenSkips++;
+      continue;
+    }
+    drawPage();
+  }
+  return 0;
 }
 
 // ROBOT STARTS HERE
 
-void init() {
-  // Startup script
-  basicScreen(false);
+//
+// EG: clawSetTorque(GRAB_HOLD);
+// Desc: Sets the claw's max torque, or what derating leaves of it
+// Vars: pct, percent
+//
+void clawSetTorque(double pct) {
+  clawTorque = pct;
+  claw.setMaxTorque(fmin(pct, clawCap), percent);
 }
-void checkClaw() {
-  basicScreen(false);
-  Brain.Screen.setCursor(3,1);
-  Brain.Screen.print("byp: %d", (bool)bypass_autoclamp);
-  Brain.Screen.setCursor(4,1);
-  Brain.Screen.print("Claw Pos: %d", (char)claw.position(degrees));
+
+//
+// EG: clawHeat();
+// Desc: Works out the claw's temperature and cuts its torque back before it
+//       overheats, runs every CLAW_TICK. The motor is a lump heated by the
+//       current squared through its windings and cooling to the air, and
+//       held at a current it heads for ambient + amps^2 * CLAW_OHMS *
+//       CLAW_HEAT_LOSS along a curve with a time constant of CLAW_HEAT_MASS
+//       * CLAW_HEAT_LOSS. No two motors are quite the data sheet, so the
+//       estimate is pulled round to the motor's own reading over CLAW_TRUST
+//       and what is left over while it draws current goes into clawGain.
+//       The torque is held to the current that would get it no hotter than
+//       CLAW_MARGIN under CLAW_HOT in CLAW_DERATE_HORIZON, so the motor
+//       never halves its own torque. Cold that is more than the claw can
+//       draw and nothing changes.
+//
+void clawHeat() {
+  uint32_t now = timer::system();
+  if (!clawSeeded) {
+    clawTemperature = claw.temperature(celsius);
+    clawHeated = now;
+    clawSeeded = true;
+    return;
+  }
+  double dt = (now - clawHeated) / 1000.0;
+  clawHeated = now;
+  double amps = claw.current(amp);
+  double squared = amps * amps;
+  clawTemperature += (squared * CLAW_OHMS * clawGain - (clawTemperature - CLAW_AMBIENT) / CLAW_HEAT_LOSS) * dt / CLAW_HEAT_MASS;
+  clawSquared += (squared - clawSquared) * fmin(1, dt / CLAW_FILTER);
+  double off = claw.temperature(celsius) - clawTemperature;
+  clawTemperature += off * fmin(1, dt / CLAW_TRUST);
+  clawGain = fmin(2, fmax(0.5, clawGain + off * squared * CLAW_LEARN * dt));
+
+  // The temperature the motor would head for to get from here to the aim
+  // in exactly the horizon, and the current that holds it there
+  double decay = exp(-CLAW_DERATE_HORIZON / (CLAW_HEAT_MASS * CLAW_HEAT_LOSS));
+  double steady = (CLAW_HOT - CLAW_MARGIN - clawTemperature * decay) / (1 - decay);
+  double most = sqrt(fmax(0, steady - CLAW_AMBIENT) / (CLAW_OHMS * clawGain * CLAW_HEAT_LOSS));
+  int cap = (int)fmin(100, floor(most / CLAW_MAX_AMPS * 100));
+  if (cap == clawCap) {
+    return;
+  }
+  double was = fmin(clawTorque, clawCap);
+  clawCap = cap;
+  if (fmin(clawTorque, clawCap) != was) {
+    claw.setMaxTorque(fmin(clawTorque, clawCap), percent);
+  }
 }
-void checkVisual() {
-  basicScreen(false);
-  Brain.Screen.setCursor(3,1);
-  Brain.Screen.print("Object found: %d", (bool)dist.foundObject());
-  Brain.Screen.setCursor(4,1);
-  Brain.Screen.print("Distance: %dmm", (int)dist.distance(mm));
+
+//
+// EG: clawTimeToHot();
+// Desc: Works out how many seconds the claw has before it overheats if it
+//       keeps drawing what it has over the last CLAW_FILTER, 0 if it is
+//       already hot and HUGE_VAL if it never would
+//
+double clawTimeToHot() {
+  double steady = CLAW_AMBIENT + clawSquared * CLAW_OHMS * clawGain * CLAW_HEAT_LOSS;
+  if (clawTemperature >= CLAW_HOT) {
+    return 0;
+  }
+  if (steady <= CLAW_HOT) {
+    return HUGE_VAL;
+  }
+  return CLAW_HEAT_MASS * CLAW_HEAT_LOSS * log((steady - clawTemperature) / (steady - CLAW_HOT));
 }
-void autoGrab() {
-  if (dist.distance(mm) < 110 && bypass_autoclamp == false) {
-    checkVisual();
-    // I found the object within 110mm of the claw. What should I do?
-    // I should go and shut the claw.
-    claw.spin(reverse);
-    claw.setVelocity(20,percent);
-    wait(2,seconds);
+
+//
+// EG: clawStalled();
+// Desc: Checks if the claw has stopped against something it is pushing on,
+//       it is barely turning and draws most of what its max torque allows.
+//       A claw getting going draws as much, so only count it after
+//       GRAB_SETTLE.
+//
+bool clawStalled() {
+  return fabs(claw.velocity(velocityUnits::rpm)) < GRAB_STALL_SPEED &&
+         claw.current(percent) >= fmin(CLAW_TORQUE, clawCap) * GRAB_STALL_CURRENT / 100.0;
+}
+
+//
+// EG: grabRelease(true);
+// Desc: Ends a grab, the claw gets its torque back and stops pushing and
+//       holding
+// Vars: stop, false when the driver is sending the claw a command instead
+//
+void grabRelease(bool stop) {
+  if (grabState != GRAB_CLOSING && grabState != GRAB_HOLDING) {
+    return;
+  }
+  clawSetTorque(CLAW_TORQUE);
+  if (stop) {
     claw.stop();
   }
+  grabState = GRAB_RELEASED;
+}
+
+//
+// EG: grabUpdate();
+// Desc: Moves the auto grab along, runs when the distance changes and every
+//       GRAB_CHECK while the claw closes. It never waits so other events
+//       keep running while the claw closes.
+//
+void grabCheck();
+void grabUpdate() {
+  int distance = (int)dist.distance(mm);
+  // The claw has stalled on the object, hold it where it is with GRAB_HOLD
+  if (grabState == GRAB_CLOSING && grabStalls >= GRAB_STALL_CHECKS) {
+    clawSetTorque(GRAB_HOLD);
+    claw.stop(brakeType::hold);
+    grabState = GRAB_HOLDING;
+  }
+  // Nothing stopped the claw, give up rather than push forever
+  if (grabState == GRAB_CLOSING && timer::system() - grabStarted >= GRAB_TIME) {
+    claw.stop();
+    grabState = GRAB_HOLDING;
+  }
+  // The object has gone, let go and wait for the next update to be ready
+  if (grabState == GRAB_HOLDING && distance >= GRAB_DISTANCE) {
+    grabRelease(true);
+    return;
+  }
+  // Nothing in front of the claw, ready to grab again
+  if (grabState == GRAB_RELEASED && distance >= GRAB_DISTANCE) {
+    grabState = GRAB_IDLE;
+  }
+  if (grabState == GRAB_IDLE && distance < GRAB_DISTANCE && bypass_autoclamp == false) {
+    showPage(PAGE_VISUAL);
+    // I found the object within 110mm of the claw. What should I do?
+    // I should go and shut the claw, until it is tight on the object.
+    claw.spin(reverse, GRAB_SPEED, percent);
+    grabStarted = timer::system();
+    grabStalls = 0;
+    grabState = GRAB_CLOSING;
+    if (!grabChecking) {
+      grabChecking = true;
+      timer::event(grabCheck, GRAB_CHECK);
+    }
+  }
+}
+void grabCheck() {
+  grabChecking = false;
+  // Stalls are counted here, a check every GRAB_CHECK, and not on every
+  // distance change
+  if (grabState == GRAB_CLOSING && timer::system() - grabStarted >= GRAB_SETTLE && clawStalled()) {
+    grabStalls++;
+  } else {
+    grabStalls = 0;
+  }
+  grabUpdate();
+  if (grabState == GRAB_CLOSING && !grabChecking) {
+    grabChecking = true;
+    timer::event(grabCheck, GRAB_CHECK);
+  }
+}
+void autoGrab() {
+  grabUpdate();
 }
 void autoClampToggle() {
   if(bypass_autoclamp == true) {
     bypass_autoclamp = false;
   } else {
     bypass_autoclamp = true; // This is so simple, thank you previous nodejs knowledge!
+    // Let go if we were in the middle of a grab
+    grabRelease(true);
   }
 }
+//
+// EG: clawShape(Controller.AxisD.position(percent));
+// Desc: Works out the claw speed for a stick position, CLAW_DEADBAND either
+//       side of the centre is stopped and the rest is stretched back to 0
+//       to 100 and bent by CLAW_CURVE for finer control near the centre
+// Vars: stick, percent
+//
+double clawShape(int stick) {
+  double size = abs(stick);
+  if (size <= CLAW_DEADBAND) {
+    return 0;
+  }
+  double x = (size - CLAW_DEADBAND) / (100.0 - CLAW_DEADBAND);
+  double y = (1 - CLAW_CURVE) * x + CLAW_CURVE * x * x * x;
+  return stick < 0 ? -100 * y : 100 * y;
+}
 void clawMovement() {
   // Clamps the Motor
   // WE NEED MAX TO MAKE A CLAMP.
@@ -126,22 +458,48 @@ void clawMovement() {
   //   claw.spin(forward);
   //   claw.setVelocity(Controller.AxisD.position(percent),percent);
   // }
-  claw.spin(forward);
-  claw.setVelocity(Controller.AxisD.position(percent),percent);
+  // The stick is shaped, the speed moves towards it by at most CLAW_SLEW
+  // a second and is only sent once it has moved by CLAW_THRESHOLD, so a
+  // stick jittering by a count or two sends nothing. Stopping and full
+  // speed always go through.
+  double target = clawShape(Controller.AxisD.position(percent));
+  double step = CLAW_SLEW * CLAW_TICK / 1000.0;
+  double move = target - clawSetpoint;
+  clawSetpoint += move > step ? step : (move < -step ? -step : move);
+  int speed = (int)round(clawSetpoint);
+  if (speed == clawSent) {
+    return;
+  }
+  if (abs(speed - clawSent) < CLAW_THRESHOLD && speed != 0 && abs(speed) != 100) {
+    return;
+  }
+  clawSent = speed;
+  // The driver has taken over from the auto grab
+  grabRelease(false);
+  claw.spin(forward, speed, percent);
+}
+int clawTask() {
+  while (true) {
+    clawMovement();
+    clawHeat();
+    wait(CLAW_TICK, msec);
+  }
+  return 0;
 }
 int main() {
-  // Initialize the robot
-  init();
-  // Allows claw movement on the D Axis
-  Controller.AxisD.changed(clawMovement);
+  // Screen, drawn by its own task below the event handlers
+  task pageDrawer = task(pageTask, task::taskPrioritylow);
+  // Allows claw movement on the D Axis, and keeps the claw from
+  // overheating while it holds things
+  task clawDriver = task(clawTask);
   // If the distance is changed, start autoGrab()
   dist.changed(autoGrab);
   // Buttons
   // Debugging Menu
-  Brain.buttonUp.pressed(checkClaw);
-  Brain.buttonDown.pressed(checkVisual);
+  Brain.buttonUp.pressed(previousPage);
+  Brain.buttonDown.pressed(nextPage);
+  Brain.buttonCheck.pressed(firstPage);
   // Turning off/on Autoclamp
   Controller.ButtonEUp.pressed(autoClampToggle);
-  checkClaw();
 }
 // ROBOT ENDS HERE
@@ -17,6 +17,7 @@
 #include "iq_apitypes.h"
 
 #include "vex_units.h"
+#include "vex_quantity.h"
 #include "vex_event.h"
 #include "vex_brain.h"
 #include "vex_controller.h"
@@ -15,6 +15,8 @@
 #define   VEX_BRAIN_CLASS_H
 
 #include "vex_timer.h"
+#include "vex_format.h"
+#include "vex_log.h"
 
 /*-----------------------------------------------------------------------------*/
 /** @file    vex_brain.h
@@ -115,6 +117,7 @@ namespace vex {
           int32_t   rowToPixel( int32_t row );
           int32_t   colToPixel( int32_t col );
           int32_t   scaley( int32_t y );
+          void      drawText( const char *str );
           
         public:
           lcd();
@@ -174,22 +177,32 @@ namespace vex {
 
           /** 
            * @brief Prints a number, string, or Boolean.
-           * @param format This is a reference to a char format that prints the value of variables.
-           * @param ... A variable list of parameters to insert into format string.
+           * @param fmt This is a reference to a char format that prints the value of variables.
+           * @param args The values to insert into format string, checked against it when compiled.
+           * @notes the format must be a string literal, text only known at run time
+           * is printed with print( "%s", text ).
           */          
-          void     print( const char *format, ... );
-          void     print( char *format, ... );
+          template <typename... Args>
+          void     print( format::string<format::identity<Args>...> fmt, Args... args ) {
+                     const format::arg list[] = { format::arg(), format::arg( args )... };
+                     format::render( _textStr, sizeof(_textStr), fmt.str, list + 1, sizeof...(Args) );
+                     drawText( _textStr );
+                   }
 
           /** 
            * @brief Prints a number, string, or Boolean at an x, y cursor location.
            * @param x The x-coordinate at which to print a message on the screen.
            * @param y The y-coordinate at which to print a message on the screen.
-           * @param format A reference to a char format to print the value of variables.
-           * @param ... A variable list of parameters to insert into format string.
+           * @param fmt A reference to a char format to print the value of variables.
+           * @param args The values to insert into format string, checked against it when compiled.
            * @notes this uses cursor location rather than pixel locati0n as on the V5
            * it's shouthand for using setCursor followed by print.
           */
-          void     printAt( int32_t x, int32_t y, const char *format, ... );
+          template <typename... Args>
+          void     printAt( int32_t x, int32_t y, format::string<format::identity<Args>...> fmt, Args... args ) {
+                     setCursor( y, x );
+                     print<Args...>( fmt, args... );
+                   }
 
           /** 
            * @brief Clears the whole Screen to white.
@@ -350,8 +363,13 @@ namespace vex {
           
           /** 
            * @brief print on the vexcode terminal
+           * @notes the message is queued and formatted later by the logger,
+           * it is dropped if the logger is full
            */
-          void print( const char *fmt, ... );
+          template <typename... Args>
+          void print( format::string<format::identity<Args>...> fmt, Args... args ) {
+                 logger::write<Args...>( logger::sink::terminal, fmt, args... );
+               }
       };
       
       terminal    Terminal;
@@ -31,10 +31,15 @@ namespace vex {
       
         /** 
          * @brief print formatted output on the serial console
-         * @param format This is a reference to a char format that prints the value of variables.
-         * @param ... A variable list of parameters to insert into format string.
+         * @return 0 once queued, -1 if the logger was full and it was dropped
+         * @param fmt This is a reference to a char format that prints the value of variables.
+         * @param args The values to insert into format string, checked against it when compiled.
+         * @notes the message is formatted later by the logger, not by the caller
         */          
-        static int32_t write( const char *fmt, ... ); 
+        template <typename... Args>
+        static int32_t write( format::string<format::identity<Args>...> fmt, Args... args ) {
+                         return( logger::write<Args...>( logger::sink::console, fmt, args... ) ? 0 : -1 );
+                       }
   };
 }
 
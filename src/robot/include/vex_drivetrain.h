@@ -153,6 +153,32 @@ namespace vex {
 
       virtual bool 	turnFor( turnType dir, double angle, rotationUnits units, double velocity, velocityUnits units_v, bool waitForCompletion=true );
 
+      // typed units, see vex_quantity.h, a rotation where a distance should be does not compile
+
+      /**
+       * @brief Turn on the motors and drive a distance at the default velocity.
+       * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+       * @param dir The direction to drive.
+       * @param distance Sets the distance to drive, e.g. 300_mm.
+       * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+      */
+      template<typename L>
+      bool 	driveFor( directionType dir, units::quantity<L> distance, bool waitForCompletion=true ) {
+          return driveFor( dir, mm_t( distance ).value(), distanceUnits::mm, waitForCompletion );
+      };
+
+      /**
+       * @brief Turn on the motors and rotate an angle at the default velocity.
+       * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+       * @param dir The direction to rotate the robot.
+       * @param angle Sets the angle to turn, e.g. 90_deg.
+       * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+      */
+      template<typename R>
+      bool 	turnFor( turnType dir, units::quantity<R> angle, bool waitForCompletion=true ) {
+          return turnFor( dir, degrees_t( angle ).value(), rotationUnits::deg, waitForCompletion );
+      };
+
       /** 
        * @brief Checks to see if any of the motors are rotating to a specific target.
        * @return Returns a true Boolean if the motor is on and is rotating to a target. Returns a false Boolean if the motor is done rotating to a target.
@@ -0,0 +1,228 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_format.h                                                */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_FORMAT_H
+#define   VEX_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_format.h
+  * @brief   Type checked formatting for the brain screen
+*//*---------------------------------------------------------------------------*/
+
+// A format string is checked against the argument types where it is used,
+// a %d given a string or a missing argument is a compile error naming the
+// problem, rather than whatever vsnprintf makes of it at run time. The
+// check needs consteval (C++20), older compilers take the string unchecked.
+//
+// Conversions are %d %i %u %x %X %c %s %f and %%, with the flags - and 0,
+// a width and, for %f, a precision of up to 9 places or, for %s, the most
+// characters of the string to print. Length modifiers
+// (l, ll, h, z ...) are accepted and ignored as the argument types are known.
+
+#if defined(__cpp_consteval)
+#define   VEX_FORMAT_CHECK  consteval
+#else
+#define   VEX_FORMAT_CHECK  constexpr
+#endif
+
+namespace vex {
+  namespace format {
+    /**
+      * @brief what an argument is formatted from
+    */
+    enum class kind : uint8_t {
+      none,
+      sint,
+      uint,
+      real,
+      text
+    };
+
+    template <typename T>
+    constexpr kind
+    kindOf() {
+      typedef typename std::decay<T>::type D;
+      if constexpr( std::is_same<D, bool>::value || (std::is_integral<D>::value && std::is_signed<D>::value) )
+        return( kind::sint );
+      else
+      if constexpr( std::is_integral<D>::value )
+        return( kind::uint );
+      else
+      if constexpr( std::is_floating_point<D>::value )
+        return( kind::real );
+      else
+      if constexpr( std::is_same<D, const char *>::value || std::is_same<D, char *>::value )
+        return( kind::text );
+      else
+        return( kind::none );
+    }
+
+    /**
+      * @brief one argument, as passed to render
+    */
+    struct arg {
+      kind  type;
+      union {
+        int64_t     i;
+        uint64_t    u;
+        double      f;
+        const char *s;
+      };
+
+      constexpr arg() : type( kind::none ), i( 0 ) {}
+
+      template <typename T>
+      arg( T v ) : type( kindOf<T>() ) {
+        static_assert( kindOf<T>() != kind::none, "type cannot be formatted" );
+        if constexpr( kindOf<T>() == kind::sint )
+          i = v;
+        else
+        if constexpr( kindOf<T>() == kind::uint )
+          u = v;
+        else
+        if constexpr( kindOf<T>() == kind::real )
+          f = v;
+        else
+          s = v;
+      }
+    };
+
+    /**
+      * @brief one conversion, parsed from after the %
+    */
+    struct spec {
+      char    conversion;
+      bool    left;
+      bool    zero;
+      int32_t width;
+      int32_t precision;    // -1 if none was given
+    };
+
+    // parse the conversion that p points after the % of, leaves p after it
+    constexpr spec
+    parse( const char *&p ) {
+      spec s = { 0, false, false, 0, -1 };
+      for( ; *p == '-' || *p == '0'; p++ ) {
+        if( *p == '-' )
+          s.left = true;
+        else
+          s.zero = true;
+      }
+      for( ; *p >= '0' && *p <= '9'; p++ )
+        s.width = s.width * 10 + (*p - '0');
+      if( *p == '.' ) {
+        s.precision = 0;
+        for( p++; *p >= '0' && *p <= '9'; p++ )
+          s.precision = s.precision * 10 + (*p - '0');
+      }
+      while( *p == 'l' || *p == 'h' || *p == 'L' || *p == 'z' || *p == 'j' || *p == 't' )
+        p++;
+      if( *p )
+        s.conversion = *p++;
+      return( s );
+    }
+
+    // Not constexpr, so reaching one while checking a format at compile
+    // time is an error that names it
+    inline void tooFewArguments() {}
+    inline void tooManyArguments() {}
+    inline void unknownConversion() {}
+    inline void argumentNeedsInteger() {}
+    inline void argumentNeedsFloat() {}
+    inline void argumentNeedsString() {}
+    inline void precisionTooLarge() {}
+
+    constexpr bool
+    known( char c ) {
+      for( const char *p = "diuxXcsf"; *p; p++ )
+        if( *p == c )
+          return( true );
+      return( false );
+    }
+
+    constexpr void
+    check( const char *p, const kind *kinds, size_t count ) {
+      size_t n = 0;
+      while( *p ) {
+        if( *p++ != '%' )
+          continue;
+        if( *p == '%' ) {
+          p++;
+          continue;
+        }
+        spec s = parse( p );
+        if( !known( s.conversion ) ) {
+          unknownConversion();
+          return;
+        }
+        if( n == count ) {
+          tooFewArguments();
+          return;
+        }
+        kind k = kinds[n++];
+        if( s.conversion == 's' ) {
+          if( k != kind::text )
+            argumentNeedsString();
+        }
+        else
+        if( s.conversion == 'f' ) {
+          if( k != kind::real )
+            argumentNeedsFloat();
+          if( s.precision > 9 )
+            precisionTooLarge();
+        }
+        else
+        if( k != kind::sint && k != kind::uint )
+          argumentNeedsInteger();
+      }
+      if( n != count )
+        tooManyArguments();
+    }
+
+    /**
+      * @brief a format string checked against the types Args
+    */
+    template <typename... Args>
+    class string {
+      public:
+        const char *str;
+
+        template <size_t N>
+        VEX_FORMAT_CHECK string( const char (&s)[N] ) : str( s ) {
+          constexpr kind kinds[] = { kindOf<Args>()..., kind::none };
+          check( s, kinds, sizeof...(Args) );
+        }
+    };
+
+    // keeps Args from being deduced from the format string
+    template <typename T>
+    struct identityType {
+      typedef T type;
+    };
+    template <typename T>
+    using identity = typename identityType<T>::type;
+
+    /**
+      * @brief format into buf, which always ends up terminated
+      * @return the number of characters written, truncated to len - 1
+      * @param buf where the text goes
+      * @param len size of buf
+      * @param format a format string already checked against args
+      * @param args the arguments
+      * @param count the number of arguments
+    */
+    int32_t render( char *buf, size_t len, const char *format, const arg *args, size_t count );
+  };
+};
+
+#endif // VEX_FORMAT_H
@@ -0,0 +1,80 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_log.h                                                   */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_LOG_H
+#define   VEX_LOG_H
+
+#include "vex_format.h"
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_log.h
+  * @brief   Deferred logging for the terminal and console
+*//*---------------------------------------------------------------------------*/
+
+// Logging a message copies the format string's address and the raw
+// arguments into a ring, nothing is formatted by the caller. A low priority
+// task formats what is queued and sends it to the terminal or console, or
+// the raw records can be saved and formatted later. If the ring is full the
+// message is dropped and counted, the caller never waits.
+
+namespace vex {
+  /**
+    * @prog_lang{pro}
+    * @brief Use the logger to print from callbacks without formatting there.
+  */
+  class logger {
+    public:
+      /**
+        * @brief where a message ends up once it is formatted
+      */
+      enum class sink : uint8_t {
+        terminal,
+        console
+      };
+
+      /**
+        * @brief queue a message for the drain task to format
+        * @return false if the ring was full and the message was dropped
+        * @param to where the message goes
+        * @param fmt format string, checked against args when compiled
+        * @param args the values to insert into the format string, a string
+        * argument is copied so it need not outlive the call
+      */
+      template <typename... Args>
+      static bool write( sink to, format::string<format::identity<Args>...> fmt, Args... args ) {
+        static_assert( sizeof...(Args) <= 8, "at most 8 arguments can be logged" );
+        const format::arg list[] = { format::arg(), format::arg( args )... };
+        return( put( to, fmt.str, list + 1, sizeof...(Args) ) );
+      }
+
+      /**
+        * @brief queue a message, what write does once the arguments are packed
+      */
+      static bool     put( sink to, const char *format, const format::arg *args, size_t count );
+
+      /**
+        * @brief format and send queued messages, the drain task calls this
+        * @return the number of messages sent
+        * @param max stop after this many, 0 for everything queued
+      */
+      static uint32_t drain( uint32_t max = 0 );
+
+      /**
+        * @brief the number of messages dropped because the ring was full
+      */
+      static uint32_t dropped();
+
+      /**
+        * @brief the number of messages drained so far
+      */
+      static uint32_t sent();
+  };
+};
+
+#endif // VEX_LOG_H
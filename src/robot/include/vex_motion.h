@@ -0,0 +1,98 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_motion.h                                                */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_MOTION_H
+#define   VEX_MOTION_H
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_motion.h
+  * @brief   Velocity, acceleration and jerk limits for profiled moves
+*//*---------------------------------------------------------------------------*/
+
+// A profiled move is worked out in full when it starts, a table of where
+// the motor should be and how fast it should be going at every control
+// tick, and the runtime then feeds the motor one entry a tick. Without a
+// jerk limit the velocity is a trapezoid, with one the corners are rounded
+// into an S-curve and the move takes acceleration / jerk longer.
+//
+// libiq has no profiled moves, so they are not in iq_cpp.h. A program that
+// uses them includes vex_motion.h after iq_cpp.h and runs on the host. A
+// profiled move is the motor's own spinTo or spinFor at the profile's
+// velocity, taken over by the profile, so the timeout and isDone work as
+// they do for any other move.
+
+namespace vex {
+  /**
+    * @prog_lang{pro}
+    * @brief Use a motionProfile to limit how hard a motor starts and stops.
+  */
+  class motionProfile {
+    public:
+      /**
+        * @brief Creates the limits for a profiled move.
+        * @param velocity the fastest the motor moves, in units.
+        * @param acceleration how quickly it gets there, in units per second.
+        * @param jerk how quickly the acceleration changes, in units per second per second, 0 for a trapezoid.
+        * @param units The measurement unit for all three.
+      */
+      explicit motionProfile( double velocity, double acceleration, double jerk = 0, velocityUnits units = velocityUnits::pct ) :
+        velocity( velocity ), acceleration( acceleration ), jerk( jerk ), units( units ) {};
+
+      double          velocity;
+      double          acceleration;
+      double          jerk;
+      velocityUnits   units;
+  };
+
+  /**
+    * @brief Turns on the motor and spins it to an absolute target rotation value, speeding up and slowing down within the limits of a motion profile.
+    * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+    * @param m The motor to move.
+    * @param rotation Sets the amount of rotation.
+    * @param units The measurement unit for the rotation value.
+    * @param profile The velocity, acceleration and jerk limits for the move.
+    * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+  */
+  bool spinTo( motor &m, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion=true );
+
+  /**
+    * @brief Turns on the motor and spins it to a relative target rotation value, speeding up and slowing down within the limits of a motion profile.
+    * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+    * @param m The motor to move.
+    * @param rotation Sets the amount of rotation.
+    * @param units The measurement unit for the rotation value.
+    * @param profile The velocity, acceleration and jerk limits for the move.
+    * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+  */
+  bool spinFor( motor &m, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion=true );
+
+  /**
+    * @brief Turns on the motors and spins them to an absolute target rotation value, speeding up and slowing down within the limits of a motion profile.
+    * @return Returns a Boolean that signifies when the motors have reached the target rotation value.
+    * @param g The motors to move.
+    * @param rotation Sets the amount of rotation.
+    * @param units The measurement unit for the rotation value.
+    * @param profile The velocity, acceleration and jerk limits for the move.
+    * @param waitForCompletion (Optional) If true, your program will wait until the motors reach the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+  */
+  bool spinTo( motor_group &g, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion=true );
+
+  /**
+    * @brief Turns on the motors and spins them to a relative target rotation value, speeding up and slowing down within the limits of a motion profile.
+    * @return Returns a Boolean that signifies when the motors have reached the target rotation value.
+    * @param g The motors to move.
+    * @param rotation Sets the amount of rotation.
+    * @param units The measurement unit for the rotation value.
+    * @param profile The velocity, acceleration and jerk limits for the move.
+    * @param waitForCompletion (Optional) If true, your program will wait until the motors reach the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+  */
+  bool spinFor( motor_group &g, double rotation, rotationUnits units, const motionProfile &profile, bool waitForCompletion=true );
+};
+
+#endif // VEX_MOTION_H
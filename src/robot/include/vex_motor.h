@@ -415,8 +415,91 @@ namespace vex {
        * @param units The measurement unit for the temperature.
        */
       double          temperature( temperatureUnits units );
- 
-      
+
+      // typed units, see vex_quantity.h. These only convert to revolutions
+      // and rpm and call the unit enum versions, and a distance where a
+      // rotation should be does not compile
+
+      /**
+       * @brief Gets the current position of the motor's encoder.
+       * @returns Returns the position in the unit Q, e.g. position<degrees_t>().
+       */
+      template<typename Q>
+      Q               position( void ) {
+          return Q( revolutions_t( position( rotationUnits::rev ) ) );
+      };
+
+      /**
+       * @brief Gets the current velocity of the motor.
+       * @returns Returns the velocity in the unit Q, e.g. velocity<rpm_t>().
+       */
+      template<typename Q>
+      Q               velocity( void ) {
+          return Q( rpm_t( velocity( velocityUnits::rpm ) ) );
+      };
+
+      /**
+       * @brief Sets the value of the motor's encoder to the value specified in the parameter.
+       * @param value Sets the current position of the motor.
+       */
+      template<typename R>
+      void            setPosition( units::quantity<R> value ) {
+          setPosition( revolutions_t( value ).value(), rotationUnits::rev );
+      };
+
+      /**
+       * @brief Sets the velocity of the motor for commands that do not give one.
+       * @param velocity Sets the amount of velocity.
+       */
+      template<typename V>
+      void            setVelocity( units::quantity<V> velocity ) {
+          setVelocity( rpm_t( velocity ).value(), velocityUnits::rpm );
+      };
+
+      /**
+       * @brief Turns the motor on, and spins it in the specified direction and a specified velocity.
+       * @param dir The direction to spin the motor. 
+       * @param velocity Sets the amount of velocity.
+       */
+      template<typename V>
+      void            spin( directionType dir, units::quantity<V> velocity ) {
+          spin( dir, rpm_t( velocity ).value(), velocityUnits::rpm );
+      };
+
+      /**
+       * @brief Turns on the motor and spins it to an absolute target rotation value at a specified velocity.
+       * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+       * @param rotation Sets the amount of rotation.
+       * @param velocity Sets the amount of velocity.
+       * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+       */
+      template<typename R, typename V>
+      bool            spinTo( units::quantity<R> rotation, units::quantity<V> velocity, bool waitForCompletion=true ) {
+          return spinTo( revolutions_t( rotation ).value(), rotationUnits::rev, rpm_t( velocity ).value(), velocityUnits::rpm, waitForCompletion );
+      };
+
+      template<typename R>
+      bool            spinTo( units::quantity<R> rotation, bool waitForCompletion=true ) {
+          return spinTo( revolutions_t( rotation ).value(), rotationUnits::rev, waitForCompletion );
+      };
+
+      /**
+       * @brief Turns on the motor and spins it to a relative target rotation value at a specified velocity.
+       * @return Returns a Boolean that signifies when the motor has reached the target rotation value.
+       * @param rotation Sets the amount of rotation.
+       * @param velocity Sets the amount of velocity.
+       * @param waitForCompletion (Optional) If true, your program will wait until the motor reaches the target rotational value. If false, the program will continue after calling this function. By default, this parameter is true.
+       */
+      template<typename R, typename V>
+      bool            spinFor( units::quantity<R> rotation, units::quantity<V> velocity, bool waitForCompletion=true ) {
+          return spinFor( revolutions_t( rotation ).value(), rotationUnits::rev, rpm_t( velocity ).value(), velocityUnits::rpm, waitForCompletion );
+      };
+
+      template<typename R>
+      bool            spinFor( units::quantity<R> rotation, bool waitForCompletion=true ) {
+          return spinFor( revolutions_t( rotation ).value(), rotationUnits::rev, waitForCompletion );
+      };
+
     protected:
       int32_t         getTimeout();
     
@@ -20,7 +20,8 @@
 *//*---------------------------------------------------------------------------*/
 
 namespace vex {
-  
+  class telemetry;
+
   class motor_group  {
     private:
       class  motor_group_impl;
@@ -50,6 +51,10 @@ namespace vex {
 
       bool waitForCompletionAll();
 
+      // the recorder samples each motor in a group
+      friend class vex::telemetry;
+      vex::motor *_motor( int32_t i );
+
     public:      
       motor_group();
       ~motor_group();
@@ -120,6 +125,17 @@ namespace vex {
        */
       void            setTimeout( int32_t time, timeUnits units );
 
+      /** 
+       * @brief Sends the group's commands together. With batching on each motor only sends the last command it was given, and not until commit is called or the next device poll, so the whole group changes at once.
+       * @param value true to batch commands, false to send each one as it is made.
+       */
+      void            setBatching( bool value );
+
+      /** 
+       * @brief Sends the commands held back while batching now rather than at the next device poll.
+       */
+      void            commit( void );
+
       /** 
        * @brief Turns the motors on, and spins them in the specified direction.
        * @param dir The direction to spin the motors.
@@ -361,6 +377,37 @@ namespace vex {
        */
       double          temperature( temperatureUnits units );
 
+      /**
+       * @brief Readings of every motor in the group, taken in one pass.
+      */
+      struct readings {
+        double        velocity;       // mean of the motors, in the units asked for
+        double        current;        // total of the motors, A
+        double        temperature;    // of the hottest motor, in the units asked for
+        bool          done;           // every motor is done
+      };
+
+      /**
+       * @brief Gets the mean velocity, total current, hottest temperature and whether all the motors are done, together.
+       * @return Returns the readings, all zero and done for an empty group.
+       * @param units_v The measurement unit for the velocity.
+       * @param units_t The measurement unit for the temperature.
+      */
+      readings        aggregate( velocityUnits units_v = velocityUnits::rpm, temperatureUnits units_t = temperatureUnits::celsius );
+
+      /**
+       * @brief Gets the mean velocity of the motors in the group.
+       * @return Returns a double that represents the mean velocity of the motors in the units defined in the parameter.
+       * @param units The measurement unit for the velocity.
+      */
+      double          averageVelocity( velocityUnits units );
+
+      /**
+       * @brief Gets the temperature of the hottest motor in the group.
+       * @return Returns the temperature of the motor in the units defined in the parameter.
+       * @param units The measurement unit for the temperature.
+      */
+      double          maxTemperature( temperatureUnits units );
   };
 }
 
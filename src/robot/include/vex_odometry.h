@@ -0,0 +1,222 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_odometry.h                                              */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_ODOMETRY_H
+#define   VEX_ODOMETRY_H
+
+#include <atomic>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_odometry.h
+  * @brief   Tracking where a drivetrain is on the field
+*//*---------------------------------------------------------------------------*/
+
+// An odometry tick runs in its own high priority task at a fixed rate,
+// sleeping until the next one is due rather than for the interval so the
+// rate does not drift. Each tick works out how far each side of the drive
+// has gone since the last one from its motor_group's position, and their
+// mean is how far the robot went. The turn comes from the gyro when there
+// is one, as wheels skid sideways while the robot turns, and from the
+// difference between the sides when there is not. The robot is taken to
+// have gone along an arc, so turning while driving does not add error.
+//
+// The tick is the only thing that writes the pose. It publishes it through
+// a poseSnapshot, a sequence count either side of the fields, so reading
+// the pose never waits on the tick and the tick never waits on a reader.
+// A reader that catches the tick part way through sees the count change
+// and reads again. x and y are mm and the heading degrees counterclockwise
+// from the x axis, where the robot was facing when the pose was zeroed.
+//
+// It is not in iq_cpp.h, as <atomic> would come into every program with it,
+// so a program that tracks its pose includes vex_odometry.h after iq_cpp.h.
+
+namespace vex {
+  class motor_group;
+  class gyro;
+
+  /**
+    * @prog_lang{pro}
+    * @brief Holds the latest pose for any number of readers and one writer, without a lock.
+  */
+  class poseSnapshot {
+    public:
+      /**
+        * @brief Where the robot is.
+      */
+      struct pose {
+        float         x;            // mm
+        float         y;            // mm
+        float         heading;      // deg, counterclockwise from the x axis
+        uint32_t      time;         // mS, timer::system() when it was worked out
+      };
+
+      poseSnapshot() : _seq( 0 ), _x( 0 ), _y( 0 ), _heading( 0 ), _time( 0 ) {};
+
+      /**
+        * @brief Publishes a new pose, only one task may do this.
+      */
+      void            store( const pose &p ) {
+          uint32_t seq = _seq.load( std::memory_order_relaxed );
+          _seq.store( seq + 1, std::memory_order_relaxed );
+          std::atomic_thread_fence( std::memory_order_release );
+          _x.store( p.x, std::memory_order_relaxed );
+          _y.store( p.y, std::memory_order_relaxed );
+          _heading.store( p.heading, std::memory_order_relaxed );
+          _time.store( p.time, std::memory_order_relaxed );
+          _seq.store( seq + 2, std::memory_order_release );
+      };
+
+      /**
+        * @brief Gets the latest pose, from any task.
+        * @return Returns a pose that was published whole, never part of one and part of another.
+      */
+      pose            load( void ) const {
+          pose     p;
+          uint32_t seq;
+          do {
+            seq       = _seq.load( std::memory_order_acquire );
+            p.x       = _x.load( std::memory_order_relaxed );
+            p.y       = _y.load( std::memory_order_relaxed );
+            p.heading = _heading.load( std::memory_order_relaxed );
+            p.time    = _time.load( std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_acquire );
+          } while( (seq & 1) || seq != _seq.load( std::memory_order_relaxed ) );
+          return p;
+      };
+
+      /**
+        * @brief Gets how many poses have been published.
+      */
+      uint32_t        count( void ) const {
+          return _seq.load( std::memory_order_acquire ) / 2;
+      };
+
+    private:
+      // odd while a store is part way through
+      std::atomic<uint32_t>   _seq;
+      std::atomic<float>      _x;
+      std::atomic<float>      _y;
+      std::atomic<float>      _heading;
+      std::atomic<uint32_t>   _time;
+
+      static_assert( std::atomic<float>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                     "poseSnapshot needs word sized atomics that do not lock" );
+  };
+
+  /**
+    * @prog_lang{pro}
+    * @brief Use odometry to keep track of where a drivetrain is on the field.
+  */
+  class odometry {
+    public:
+      typedef poseSnapshot::pose pose;
+
+      /**
+        * @brief Creates odometry for two motor groups, turns are worked out from the wheels.
+        * @param l The left side of the drive.
+        * @param r The right side, forward has to turn the same way as the left.
+        * @param wheelTravel The distance the wheels go in one turn.
+        * @param trackWidth The distance between the left and right wheels.
+        * @param unit The measurement unit for wheelTravel and trackWidth.
+        * @param externalGearRatio Motor turns for each turn of the wheels.
+      */
+      odometry( motor_group &l, motor_group &r, double wheelTravel=200, double trackWidth=200, distanceUnits unit=distanceUnits::mm, double externalGearRatio = 1.0 );
+
+      /**
+        * @brief Creates odometry for two motor groups with a gyro for the turns.
+      */
+      odometry( motor_group &l, motor_group &r, vex::gyro &g, double wheelTravel=200, double trackWidth=200, distanceUnits unit=distanceUnits::mm, double externalGearRatio = 1.0 );
+
+      ~odometry();
+
+      /**
+        * @brief Starts the odometry tick, from where the drive is now.
+        * @param interval mS between ticks. The motors' readings change every device poll, 10mS.
+      */
+      void            start( uint32_t interval = 10 );
+
+      /**
+        * @brief Stops the odometry tick, the last pose is kept.
+      */
+      void            stop( void );
+
+      /**
+        * @brief Sets where the robot is, the next tick goes on from there.
+        * @param x Sets the distance along the field.
+        * @param y Sets the distance across the field.
+        * @param heading Sets the way the robot faces, counterclockwise from the x axis.
+        * @param units_d The measurement unit for x and y.
+        * @param units_r The measurement unit for the heading.
+      */
+      void            setPose( double x, double y, double heading, distanceUnits units_d, rotationUnits units_r );
+
+      /**
+        * @brief Gets the latest pose without waiting on the tick.
+        * @return Returns x and y in mm and the heading in degrees, with the time it was worked out.
+      */
+      pose            get( void ) const {
+          return _pose.load();
+      };
+
+      /**
+        * @brief Gets the distance along the field.
+        * @param units The measurement unit for the distance.
+      */
+      double          x( distanceUnits units = distanceUnits::mm ) const;
+
+      /**
+        * @brief Gets the distance across the field.
+        * @param units The measurement unit for the distance.
+      */
+      double          y( distanceUnits units = distanceUnits::mm ) const;
+
+      /**
+        * @brief Gets the way the robot faces, counterclockwise from the x axis, -180 to 180 degrees.
+        * @param units The measurement unit for the heading.
+      */
+      double          heading( rotationUnits units = rotationUnits::deg ) const;
+
+      /**
+        * @brief Gets how many ticks have published a pose.
+      */
+      uint32_t        ticks( void ) const {
+          return _pose.count();
+      };
+
+    private:
+      vex::motor_group *_left;
+      vex::motor_group *_right;
+      vex::gyro       *_gyro;
+      double          _travel;          // mm a motor revolution
+      double          _track;           // mm
+
+      // the tick's own state, only it touches these once running
+      double          _x;               // mm
+      double          _y;
+      double          _theta;           // rad, unwrapped
+      double          _lastLeft;        // mm
+      double          _lastRight;
+      double          _lastGyro;        // rad
+      bool            _primed;
+
+      uint32_t        _interval;        // mS
+
+      // setPose hands the tick a new pose rather than writing it
+      pose            _reset;
+      std::atomic<bool> _resetPending;
+
+      poseSnapshot    _pose;
+
+      void            _init( motor_group &l, motor_group &r, vex::gyro *g, double wheelTravel, double trackWidth, distanceUnits unit, double externalGearRatio );
+      void            _step( void );
+      static void     _run( void *arg );
+  };
+};
+
+#endif // VEX_ODOMETRY_H
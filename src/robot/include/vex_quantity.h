@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_quantity.h                                              */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_QUANTITY_H
+#define   VEX_QUANTITY_H
+
+#include <type_traits>
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_quantity.h
+  * @brief   Typed units, the unit is part of the type so it is fixed when the program is compiled
+*//*---------------------------------------------------------------------------*/
+
+// A value in rotationUnits or velocityUnits is a double and an enum, and
+// every call that takes one switches on the enum to convert it. A
+// degrees_t is a double whose type says it is in degrees. Converting it
+// to another unit of the same kind is a multiply by a constant the
+// compiler works out, converting it to a unit of a different kind, say
+// degrees to mm, does not compile.
+//
+//   claw.spinTo( 90_deg, 60_rpm );
+//   degrees_t d = claw.position<degrees_t>();
+//   revolutions_t r = d;          // d / 360
+//   mm_t m = d;                   // error
+
+namespace vex {
+  namespace units {
+    // what a unit measures, only units that measure the same thing convert
+    struct rotation;
+    struct angularVelocity;
+    struct length;
+
+    /**
+      * @brief A unit, what it measures and how many of the first unit of that kind it is, as num / den.
+    */
+    template<typename D, long num, long den = 1>
+    struct unit {
+      typedef D dimension;
+      static constexpr double scale = (double)num / den;
+    };
+
+    /**
+      * @prog_lang{pro}
+      * @brief A value in unit U.
+    */
+    template<typename U>
+    class quantity {
+      public:
+        typedef U unit;
+
+        constexpr explicit quantity( double value ) : _value( value ) {};
+
+        /**
+          * @brief Converts from another unit of the same kind.
+        */
+        template<typename V, typename = typename std::enable_if<std::is_same<typename U::dimension, typename V::dimension>::value>::type>
+        constexpr quantity( quantity<V> q ) : _value( q.value() * (V::scale / U::scale) ) {};
+
+        /**
+          * @brief Gets the value as a plain number in this unit.
+        */
+        constexpr double value() const { return _value; };
+
+        constexpr quantity operator-() const { return quantity( -_value ); };
+
+        friend constexpr quantity operator+( quantity a, quantity b ) { return quantity( a._value + b._value ); };
+        friend constexpr quantity operator-( quantity a, quantity b ) { return quantity( a._value - b._value ); };
+        friend constexpr quantity operator*( quantity a, double k ) { return quantity( a._value * k ); };
+        friend constexpr quantity operator*( double k, quantity a ) { return quantity( a._value * k ); };
+        friend constexpr quantity operator/( quantity a, double k ) { return quantity( a._value / k ); };
+
+        friend constexpr bool operator==( quantity a, quantity b ) { return a._value == b._value; };
+        friend constexpr bool operator!=( quantity a, quantity b ) { return a._value != b._value; };
+        friend constexpr bool operator<( quantity a, quantity b ) { return a._value < b._value; };
+        friend constexpr bool operator>( quantity a, quantity b ) { return a._value > b._value; };
+        friend constexpr bool operator<=( quantity a, quantity b ) { return a._value <= b._value; };
+        friend constexpr bool operator>=( quantity a, quantity b ) { return a._value >= b._value; };
+
+      private:
+        double      _value;
+    };
+  };
+
+  typedef units::quantity<units::unit<units::rotation, 1>>              degrees_t;
+  typedef units::quantity<units::unit<units::rotation, 360>>            revolutions_t;
+
+  typedef units::quantity<units::unit<units::angularVelocity, 1>>       rpm_t;
+  typedef units::quantity<units::unit<units::angularVelocity, 1, 6>>    dps_t;
+
+  typedef units::quantity<units::unit<units::length, 1>>                mm_t;
+  typedef units::quantity<units::unit<units::length, 10>>               cm_t;
+  typedef units::quantity<units::unit<units::length, 254, 10>>          inches_t;
+
+  constexpr degrees_t     operator""_deg( long double v )             { return degrees_t( (double)v ); };
+  constexpr degrees_t     operator""_deg( unsigned long long v )      { return degrees_t( (double)v ); };
+  constexpr revolutions_t operator""_rev( long double v )             { return revolutions_t( (double)v ); };
+  constexpr revolutions_t operator""_rev( unsigned long long v )      { return revolutions_t( (double)v ); };
+  constexpr rpm_t         operator""_rpm( long double v )             { return rpm_t( (double)v ); };
+  constexpr rpm_t         operator""_rpm( unsigned long long v )      { return rpm_t( (double)v ); };
+  constexpr dps_t         operator""_dps( long double v )             { return dps_t( (double)v ); };
+  constexpr dps_t         operator""_dps( unsigned long long v )      { return dps_t( (double)v ); };
+  constexpr mm_t          operator""_mm( long double v )              { return mm_t( (double)v ); };
+  constexpr mm_t          operator""_mm( unsigned long long v )       { return mm_t( (double)v ); };
+  constexpr cm_t          operator""_cm( long double v )              { return cm_t( (double)v ); };
+  constexpr cm_t          operator""_cm( unsigned long long v )       { return cm_t( (double)v ); };
+  constexpr inches_t      operator""_in( long double v )              { return inches_t( (double)v ); };
+  constexpr inches_t      operator""_in( unsigned long long v )       { return inches_t( (double)v ); };
+};
+
+#endif // VEX_QUANTITY_H
@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:     vex_telemetry.h                                             */
+/*                                                                            */
+/*    Revisions:                                                              */
+/*                V1.00     TBD - Initial release                             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#ifndef   VEX_TELEMETRY_H
+#define   VEX_TELEMETRY_H
+
+/*-----------------------------------------------------------------------------*/
+/** @file    vex_telemetry.h
+  * @brief   Recording motor readings at a fixed rate for plotting afterwards
+*//*---------------------------------------------------------------------------*/
+
+// Motors added to the recorder are sampled together every interval, one
+// sample a motor with the time from timer::system(). Samples go into a
+// ring that is set aside when the program is built, so recording never
+// allocates, and a tick costs the same for the same motors however long
+// it has been running. Once the ring is full the oldest samples make way
+// and are counted as lost. What is held can be saved as CSV, or packed
+// binary that logdecode turns into the same CSV later.
+//
+// The recorder is the host's, the robot's firmware has nothing like it, so
+// it is not in iq_cpp.h. The host runtime and baller include it through
+// vex_sim.h, a program run on the host includes it after iq_cpp.h.
+
+namespace vex {
+  class motor;
+  class motor_group;
+
+  /**
+    * @prog_lang{pro}
+    * @brief Use the telemetry recorder to sample motors while tuning.
+  */
+  class telemetry {
+    public:
+      /**
+        * @brief One reading of one motor.
+      */
+      struct sample {
+        uint32_t      time;           // mS, timer::system()
+        uint8_t       port;           // 0 for PORT1
+        float         position;       // deg
+        float         velocity;       // rpm
+        float         current;        // A
+        float         voltage;        // V
+        float         torque;         // Nm
+        float         temperature;    // C
+      };
+
+      /**
+        * @brief How save writes the samples.
+      */
+      enum class fileType {
+        csv,
+        binary
+      };
+
+      /**
+        * @brief Adds a motor to those sampled.
+        * @return Returns false if the recorder already has as many motors as it can sample.
+        * @param m The motor, it has to outlive the recording.
+      */
+      static bool     add( motor &m );
+
+      /**
+        * @brief Adds every motor in a motor group to those sampled.
+        * @return Returns false if some of them did not fit.
+        * @param g The motor group.
+      */
+      static bool     add( motor_group &g );
+
+      /**
+        * @brief Stops recording and forgets the motors and the samples.
+      */
+      static void     clear( void );
+
+      /**
+        * @brief Starts sampling every motor added.
+        * @param interval mS between samples. The motors' readings change every device poll, 10mS.
+      */
+      static void     start( uint32_t interval );
+
+      /**
+        * @brief Stops sampling, the samples are kept.
+      */
+      static void     stop( void );
+
+      /**
+        * @brief Gets how many samples are held.
+      */
+      static uint32_t count( void );
+
+      /**
+        * @brief Gets how many of the oldest samples made way for newer ones.
+      */
+      static uint32_t lost( void );
+
+      /**
+        * @brief Gets a held sample, 0 is the oldest.
+        * @return Returns false if there are not that many.
+      */
+      static bool     get( uint32_t index, sample &s );
+
+      /**
+        * @brief Writes the held samples to a file.
+        * @return Returns false if the file could not be written.
+        * @param path Where to write them.
+        * @param type CSV, or packed binary for logdecode.
+      */
+      static bool     save( const char *path, fileType type );
+  };
+};
+
+#endif // VEX_TELEMETRY_H